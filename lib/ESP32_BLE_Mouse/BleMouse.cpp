@@ -1,6 +1,7 @@
 #include "BleMouse.h"
 
 #include <Arduino.h>
+#include <string.h>
 #include "HIDTypes.h"
 
 namespace {
@@ -8,14 +9,120 @@ constexpr uint16_t kConnMinInterval = 0x06;  // 7.5 ms
 constexpr uint16_t kConnMaxInterval = 0x09;  // 11.25 ms
 constexpr uint16_t kConnLatency = 0;
 constexpr uint16_t kConnTimeout = 400;       // 4 seconds
+// Idle: 60 ms * (4 + 1) = 300 ms between forced events, well inside the timeout.
+constexpr uint16_t kIdleConnMinInterval = 0x24;  // 45 ms
+constexpr uint16_t kIdleConnMaxInterval = 0x30;  // 60 ms
+constexpr uint16_t kIdleConnLatency = 4;
 constexpr uint16_t kPairingDisconnectWaitMs = 1000;
+// Reconnect advertising: a short directed burst, then a whitelisted phase at the same fast
+// interval for hosts that ignore directed advertising, then open advertising at the stack
+// default interval.
+constexpr uint32_t kDirectedAdvMs = 1280;
+constexpr uint32_t kWhitelistAdvMs = 10000;
+constexpr uint16_t kFastAdvMinInterval = 0x20;  // 20 ms
+constexpr uint16_t kFastAdvMaxInterval = 0x30;  // 30 ms
+constexpr uint32_t kConnIntervalUnitUs = 1250;
+constexpr int32_t kMaxPendingMotion = 2048;  // Bound on unsent motion while the link is congested
 
-static const uint8_t kHidReportDescriptor[] = {
+bool clampPending(int32_t& pending) {
+  if (pending > kMaxPendingMotion) {
+    pending = kMaxPendingMotion;
+    return true;
+  }
+  if (pending < -kMaxPendingMotion) {
+    pending = -kMaxPendingMotion;
+    return true;
+  }
+  return false;
+}
+
+constexpr uint8_t kMouseReportId = 1;
+constexpr uint8_t kKeyboardReportId = 2;
+constexpr uint8_t kConsumerReportId = 3;
+constexpr uint8_t kWheelMultiplierBits = 0x03;
+constexpr uint8_t kHWheelMultiplierBits = 0x0C;
+
+// Takes up to +/-limit report counts from pending, where one count is `unit` pending units.
+// The remainder (including any sub-count fraction) stays pending.
+int32_t takeReportAxis(int32_t& pending, int32_t limit, int32_t unit) {
+  int32_t value = pending / unit;
+  value = (value > limit) ? limit : ((value < -limit) ? -limit : value);
+  pending -= value * unit;
+  return value;
+}
+
+void putLe16(uint8_t* p, int32_t value) {
+  p[0] = static_cast<uint8_t>(value & 0xFF);
+  p[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+}
+
+// Report byte layouts; the descriptors below are checked against them at compile time.
+constexpr size_t kMouseReportBytes = 5;          // buttons, X, Y, wheel, pan (8 bit each)
+constexpr size_t kMouseHighResReportBytes = 9;   // buttons(8) X(16) Y(16) wheel(16) pan(16)
+constexpr size_t kKeyboardModifierOffset = 0;
+constexpr size_t kKeyboardKeysOffset = 2;        // After the reserved byte
+constexpr size_t kKeyboardLedReportBytes = 1;    // Output: five LED bits plus padding
+constexpr size_t kConsumerReportBytes = BLE_CONSUMER_REPORT_BYTES;  // One 16-bit Consumer page usage
+static_assert(kKeyboardKeysOffset + BLE_KEYBOARD_KEY_SLOTS == BLE_KEYBOARD_REPORT_BYTES,
+              "keyboard report is modifiers, reserved, then the key slots");
+
+// Keyboard (boot layout: modifiers, reserved, six key slots; LED output report) and consumer
+// control collections, shared by both mouse layouts.
+#define BLE_HID_KEYBOARD_AND_CONSUMER                                                          \
+  USAGE_PAGE(1),       0x01,                                                                   \
+  USAGE(1),            0x06,                                                                   \
+  COLLECTION(1),       0x01,                                                                   \
+  REPORT_ID(1),        kKeyboardReportId,                                                      \
+  USAGE_PAGE(1),       0x07,                                                                   \
+  USAGE_MINIMUM(1),    0xe0,                                                                   \
+  USAGE_MAXIMUM(1),    0xe7,                                                                   \
+  LOGICAL_MINIMUM(1),  0x00,                                                                   \
+  LOGICAL_MAXIMUM(1),  0x01,                                                                   \
+  REPORT_SIZE(1),      0x01,                                                                   \
+  REPORT_COUNT(1),     0x08,                                                                   \
+  HIDINPUT(1),         0x02,                                                                   \
+  REPORT_SIZE(1),      0x08,                                                                   \
+  REPORT_COUNT(1),     0x01,                                                                   \
+  HIDINPUT(1),         0x01,                                                                   \
+  USAGE_PAGE(1),       0x08,                                                                   \
+  USAGE_MINIMUM(1),    0x01,                                                                   \
+  USAGE_MAXIMUM(1),    0x05,                                                                   \
+  REPORT_SIZE(1),      0x01,                                                                   \
+  REPORT_COUNT(1),     0x05,                                                                   \
+  HIDOUTPUT(1),        0x02,                                                                   \
+  REPORT_SIZE(1),      0x03,                                                                   \
+  REPORT_COUNT(1),     0x01,                                                                   \
+  HIDOUTPUT(1),        0x01,                                                                   \
+  USAGE_PAGE(1),       0x07,                                                                   \
+  USAGE_MINIMUM(1),    0x00,                                                                   \
+  USAGE_MAXIMUM(1),    0x65,                                                                   \
+  LOGICAL_MINIMUM(1),  0x00,                                                                   \
+  LOGICAL_MAXIMUM(1),  0x65,                                                                   \
+  REPORT_SIZE(1),      0x08,                                                                   \
+  REPORT_COUNT(1),     BLE_KEYBOARD_KEY_SLOTS,                                                 \
+  HIDINPUT(1),         0x00,                                                                   \
+  END_COLLECTION(0),                                                                           \
+  USAGE_PAGE(1),       0x0c,                                                                   \
+  USAGE(1),            0x01,                                                                   \
+  COLLECTION(1),       0x01,                                                                   \
+  REPORT_ID(1),        kConsumerReportId,                                                      \
+  USAGE_MINIMUM(1),    0x00,                                                                   \
+  USAGE_MAXIMUM(2),    0xff, 0x03,                                                             \
+  LOGICAL_MINIMUM(1),  0x00,                                                                   \
+  LOGICAL_MAXIMUM(2),  0xff, 0x03,                                                             \
+  REPORT_SIZE(1),      0x10,                                                                   \
+  REPORT_COUNT(1),     0x01,                                                                   \
+  HIDINPUT(1),         0x00,                                                                   \
+  END_COLLECTION(0)
+
+// Mouse input report 1: buttons, X, Y, wheel, pan (8 bit each).
+constexpr uint8_t kHidReportDescriptor[] = {
   USAGE_PAGE(1),       0x01,
   USAGE(1),            0x02,
   COLLECTION(1),       0x01,
   USAGE(1),            0x01,
   COLLECTION(1),       0x00,
+  REPORT_ID(1),        kMouseReportId,
   USAGE_PAGE(1),       0x09,
   USAGE_MINIMUM(1),    0x01,
   USAGE_MAXIMUM(1),    0x05,
@@ -44,8 +151,148 @@ static const uint8_t kHidReportDescriptor[] = {
   REPORT_COUNT(1),     0x01,
   HIDINPUT(1),         0x06,
   END_COLLECTION(0),
-  END_COLLECTION(0)
+  END_COLLECTION(0),
+  BLE_HID_KEYBOARD_AND_CONSUMER
 };
+
+// Mouse input report 1: buttons(8) X(16) Y(16) wheel(16) pan(16).
+// Feature report 1: wheel/pan Resolution Multiplier (2 bits each, x1 or x8).
+constexpr uint8_t kHidReportDescriptorHighRes[] = {
+  USAGE_PAGE(1),       0x01,
+  USAGE(1),            0x02,
+  COLLECTION(1),       0x01,
+  USAGE(1),            0x01,
+  COLLECTION(1),       0x00,
+  REPORT_ID(1),        kMouseReportId,
+  USAGE_PAGE(1),       0x09,
+  USAGE_MINIMUM(1),    0x01,
+  USAGE_MAXIMUM(1),    0x05,
+  LOGICAL_MINIMUM(1),  0x00,
+  LOGICAL_MAXIMUM(1),  0x01,
+  REPORT_SIZE(1),      0x01,
+  REPORT_COUNT(1),     0x05,
+  HIDINPUT(1),         0x02,
+  REPORT_SIZE(1),      0x03,
+  REPORT_COUNT(1),     0x01,
+  HIDINPUT(1),         0x03,
+  USAGE_PAGE(1),       0x01,
+  USAGE(1),            0x30,
+  USAGE(1),            0x31,
+  LOGICAL_MINIMUM(2),  0x01, 0x80,
+  LOGICAL_MAXIMUM(2),  0xff, 0x7f,
+  REPORT_SIZE(1),      0x10,
+  REPORT_COUNT(1),     0x02,
+  HIDINPUT(1),         0x06,
+  COLLECTION(1),       0x02,
+  USAGE(1),            0x48,
+  LOGICAL_MINIMUM(1),  0x00,
+  LOGICAL_MAXIMUM(1),  0x01,
+  PHYSICAL_MINIMUM(1), 0x01,
+  PHYSICAL_MAXIMUM(1), MOUSE_WHEEL_RESOLUTION,
+  REPORT_SIZE(1),      0x02,
+  REPORT_COUNT(1),     0x01,
+  FEATURE(1),          0x02,
+  PHYSICAL_MINIMUM(1), 0x00,
+  PHYSICAL_MAXIMUM(1), 0x00,
+  USAGE(1),            0x38,
+  LOGICAL_MINIMUM(2),  0x01, 0x80,
+  LOGICAL_MAXIMUM(2),  0xff, 0x7f,
+  REPORT_SIZE(1),      0x10,
+  REPORT_COUNT(1),     0x01,
+  HIDINPUT(1),         0x06,
+  END_COLLECTION(0),
+  COLLECTION(1),       0x02,
+  USAGE(1),            0x48,
+  LOGICAL_MINIMUM(1),  0x00,
+  LOGICAL_MAXIMUM(1),  0x01,
+  PHYSICAL_MINIMUM(1), 0x01,
+  PHYSICAL_MAXIMUM(1), MOUSE_WHEEL_RESOLUTION,
+  REPORT_SIZE(1),      0x02,
+  REPORT_COUNT(1),     0x01,
+  FEATURE(1),          0x02,
+  PHYSICAL_MINIMUM(1), 0x00,
+  PHYSICAL_MAXIMUM(1), 0x00,
+  REPORT_SIZE(1),      0x04,
+  REPORT_COUNT(1),     0x01,
+  FEATURE(1),          0x03,
+  USAGE_PAGE(1),       0x0c,
+  USAGE(2),      0x38, 0x02,
+  LOGICAL_MINIMUM(2),  0x01, 0x80,
+  LOGICAL_MAXIMUM(2),  0xff, 0x7f,
+  REPORT_SIZE(1),      0x10,
+  REPORT_COUNT(1),     0x01,
+  HIDINPUT(1),         0x06,
+  END_COLLECTION(0),
+  END_COLLECTION(0),
+  END_COLLECTION(0),
+  BLE_HID_KEYBOARD_AND_CONSUMER
+};
+#undef BLE_HID_KEYBOARD_AND_CONSUMER
+
+// Compile-time descriptor walk (C++11 constexpr, one item per recursion) for the layout checks
+// below: item data is 0, 1, 2 or 4 bytes; Report ID/Size/Count are global items.
+constexpr uint8_t kItemTagMask = 0xfc;
+constexpr uint8_t kInputTag = HIDINPUT(0);
+constexpr uint8_t kOutputTag = HIDOUTPUT(0);
+constexpr uint8_t kFeatureTag = FEATURE(0);
+
+constexpr size_t itemDataBytes(uint8_t prefix) {
+  return (prefix & 0x03) == 0x03 ? 4 : (prefix & 0x03);
+}
+
+constexpr uint32_t itemData(const uint8_t* d, size_t pos) {
+  return itemDataBytes(d[pos]) == 0   ? 0u
+         : itemDataBytes(d[pos]) == 1 ? d[pos + 1]
+         : itemDataBytes(d[pos]) == 2 ? static_cast<uint32_t>(d[pos + 1] | (d[pos + 2] << 8))
+                                      : static_cast<uint32_t>(d[pos + 1] | (d[pos + 2] << 8) | (d[pos + 3] << 16) |
+                                                              (static_cast<uint32_t>(d[pos + 4]) << 24));
+}
+
+constexpr size_t nextItem(const uint8_t* d, size_t pos) {
+  return pos + 1 + itemDataBytes(d[pos]);
+}
+
+// Total bits of the main items with `tag` (input, output or feature) in report `id`.
+constexpr uint32_t reportBits(const uint8_t* d, size_t len, uint8_t tag, uint32_t id, size_t pos = 0,
+                              uint32_t curId = 0, uint32_t size = 0, uint32_t count = 0) {
+  return pos >= len ? 0u
+         : (d[pos] & kItemTagMask) == REPORT_ID(0)
+             ? reportBits(d, len, tag, id, nextItem(d, pos), itemData(d, pos), size, count)
+         : (d[pos] & kItemTagMask) == REPORT_SIZE(0)
+             ? reportBits(d, len, tag, id, nextItem(d, pos), curId, itemData(d, pos), count)
+         : (d[pos] & kItemTagMask) == REPORT_COUNT(0)
+             ? reportBits(d, len, tag, id, nextItem(d, pos), curId, size, itemData(d, pos))
+             : ((d[pos] & kItemTagMask) == tag && curId == id ? size * count : 0u) +
+                   reportBits(d, len, tag, id, nextItem(d, pos), curId, size, count);
+}
+
+// True when every collection is closed, none is closed twice, and the last item ends exactly
+// at the end of the array.
+constexpr bool collectionsBalanced(const uint8_t* d, size_t len, size_t pos = 0, int depth = 0) {
+  return pos >= len ? (pos == len && depth == 0)
+         : depth < 0 ? false
+                     : collectionsBalanced(d, len, nextItem(d, pos),
+                                           depth + ((d[pos] & kItemTagMask) == COLLECTION(0)       ? 1
+                                                    : (d[pos] & kItemTagMask) == END_COLLECTION(0) ? -1
+                                                                                                   : 0));
+}
+
+template <size_t N>
+constexpr bool compositeLayoutMatches(const uint8_t (&d)[N], size_t mouseBytes, uint32_t mouseFeatureBits) {
+  return collectionsBalanced(d, N) &&
+         reportBits(d, N, kInputTag, 0) == 0 &&  // Every input item sits under a report ID
+         reportBits(d, N, kInputTag, kMouseReportId) == mouseBytes * 8 &&
+         reportBits(d, N, kFeatureTag, kMouseReportId) == mouseFeatureBits &&
+         reportBits(d, N, kInputTag, kKeyboardReportId) == BLE_KEYBOARD_REPORT_BYTES * 8 &&
+         reportBits(d, N, kOutputTag, kKeyboardReportId) == kKeyboardLedReportBytes * 8 &&
+         reportBits(d, N, kInputTag, kConsumerReportId) == kConsumerReportBytes * 8 &&
+         reportBits(d, N, kOutputTag, kMouseReportId) == 0 && reportBits(d, N, kFeatureTag, kKeyboardReportId) == 0;
+}
+
+static_assert(compositeLayoutMatches(kHidReportDescriptor, kMouseReportBytes, 0),
+              "legacy descriptor does not match the report layouts sendPendingReport()/sendKeyReport() write");
+static_assert(compositeLayoutMatches(kHidReportDescriptorHighRes, kMouseHighResReportBytes, 8),
+              "high-res descriptor does not match the report layouts sendPendingReport()/sendKeyReport() write");
 }  // namespace
 
 class BleMouse::ServerCallbacks : public NimBLEServerCallbacks {
@@ -53,22 +300,60 @@ class BleMouse::ServerCallbacks : public NimBLEServerCallbacks {
   explicit ServerCallbacks(BleMouse* owner) : owner_(owner) {}
 
   void onConnect(NimBLEServer* pServer, NimBLEConnInfo& connInfo) override {
+    (void)pServer;
+    owner_->reconnectStats.lastMs = millis() - owner_->reconnectStartMs;
+    owner_->reconnectStats.lastPhase = owner_->advPhase;
+    ++owner_->reconnectStats.connections;
+    owner_->advPhase = BleMouseAdvPhase::Off;
     owner_->connected = true;
-    pServer->updateConnParams(connInfo.getConnHandle(),
-                              kConnMinInterval,
-                              kConnMaxInterval,
-                              kConnLatency,
-                              kConnTimeout);
+    owner_->connHandle = connInfo.getConnHandle();
+    owner_->connIntervalUs = connInfo.getConnInterval() * kConnIntervalUnitUs;
+    owner_->connLatency = connInfo.getConnLatency();
+    owner_->requestLinkParams(connInfo.getConnHandle());
+  }
+
+  void onConnParamsUpdate(NimBLEConnInfo& connInfo) override {
+    owner_->connIntervalUs = connInfo.getConnInterval() * kConnIntervalUnitUs;
+    owner_->connLatency = connInfo.getConnLatency();
+    ++owner_->linkStats.updates;
+    if (owner_->linkRequestPending) {
+      owner_->linkRequestPending = false;
+      owner_->linkStats.lastUpdateUs = micros() - owner_->linkRequestUs;
+    }
   }
 
   void onDisconnect(NimBLEServer* pServer, NimBLEConnInfo& connInfo, int reason) override {
+    (void)pServer;
     (void)connInfo;
     (void)reason;
     owner_->connected = false;
-    if (owner_->advertising != nullptr && !owner_->advertising->isAdvertising()) {
-      owner_->advertising->start();
-    } else {
-      pServer->startAdvertising();
+    owner_->wheelMultiplier = 0;
+    owner_->disconnectPending = true;
+    owner_->pairingPending = false;
+    owner_->reconnectStartMs = millis();
+    owner_->requestAdvertisingPhase(BleMouseAdvPhase::Directed);
+  }
+
+  void onAuthenticationComplete(NimBLEConnInfo& connInfo) override {
+    if (connInfo.isBonded()) {
+      owner_->storeBondedHost(connInfo.getIdAddress());
+    }
+  }
+
+ private:
+  BleMouse* owner_;
+};
+
+// Tracks the host's Resolution Multiplier writes (high-resolution mode only).
+class BleMouse::FeatureCallbacks : public NimBLECharacteristicCallbacks {
+ public:
+  explicit FeatureCallbacks(BleMouse* owner) : owner_(owner) {}
+
+  void onWrite(NimBLECharacteristic* pCharacteristic, NimBLEConnInfo& connInfo) override {
+    (void)connInfo;
+    const NimBLEAttValue value = pCharacteristic->getValue();
+    if (value.size() > 0) {
+      owner_->wheelMultiplier = value.data()[0];
     }
   }
 
@@ -78,15 +363,57 @@ class BleMouse::ServerCallbacks : public NimBLEServerCallbacks {
 
 BleMouse::BleMouse(std::string deviceName, std::string deviceManufacturer, uint8_t batteryLevel)
     : _buttons(0),
+      buttonQueue{},
+      buttonQueued(0),
       hid(nullptr),
       inputMouse(nullptr),
+      featureMouse(nullptr),
+      inputKeyboard(nullptr),
+      outputKeyboard(nullptr),
+      inputConsumer(nullptr),
       server(nullptr),
       advertising(nullptr),
       connected(false),
+      reportMode(BleMouseReportMode::Legacy8),
+      wheelMultiplier(0),
+      pendingX(0),
+      pendingY(0),
+      pendingWheel(0),
+      pendingHWheel(0),
+      pendingReport(false),
+      lastReportUs(0),
+      connIntervalUs(kConnMinInterval * kConnIntervalUnitUs),
+      connHandle(0),
+      connLatency(0),
+      linkProfile(BleMouseLinkProfile::Fast),
+      linkRequestUs(0),
+      linkRequestPending(false),
+      linkStats{0, 0, 0, 0, 0},
+      lastNotifyFailed(false),
+      stats{0, 0, 0, 0, 0, 0, 0, 0, 0},
+      reportObserver(nullptr),
+      reportObserverContext(nullptr),
+      keyboardReport{},
+      consumerReport{},
+      keyboardQueue{},
+      consumerQueue{},
+      lastKeyResendUs(0),
+      hosts{},
+      hostSlot(0),
+      hostsRevision(0),
+      advPhase(BleMouseAdvPhase::Off),
+      advRequestPhase(BleMouseAdvPhase::Off),
+      advRequested(false),
+      disconnectPending(false),
+      reconnectStartMs(0),
+      reconnectStats{0, BleMouseAdvPhase::Off, 0},
+      pairingPending(false),
+      pairingRequestMs(0),
       batteryLevel(batteryLevel),
       deviceManufacturer(deviceManufacturer),
       deviceName(deviceName),
-      callbacks(nullptr) {}
+      callbacks(nullptr),
+      featureCallbacks(nullptr) {}
 
 void BleMouse::begin(void) {
   if (!NimBLEDevice::isInitialized()) {
@@ -103,21 +430,38 @@ void BleMouse::begin(void) {
     this->callbacks = new ServerCallbacks(this);
   }
   this->server->setCallbacks(this->callbacks, false);
-  this->server->advertiseOnDisconnect(true);
+  this->server->advertiseOnDisconnect(false);  // onDisconnect runs the reconnect phases
 
   this->hid = new NimBLEHIDDevice(this->server);
-  this->inputMouse = this->hid->getInputReport(0);
-
   this->hid->setManufacturer(this->deviceManufacturer);
   this->hid->setPnp(0x02, 0xe502, 0xa111, 0x0210);
   this->hid->setHidInfo(0x00, 0x02);
-  this->hid->setReportMap((uint8_t*)kHidReportDescriptor, sizeof(kHidReportDescriptor));
+  if (this->reportMode == BleMouseReportMode::HighRes16) {
+    this->inputMouse = this->hid->getInputReport(kMouseReportId);
+    this->featureMouse = this->hid->getFeatureReport(kMouseReportId);
+    if (this->featureCallbacks == nullptr) {
+      this->featureCallbacks = new FeatureCallbacks(this);
+    }
+    const uint8_t feature = 0;
+    this->featureMouse->setValue(&feature, sizeof(feature));
+    this->featureMouse->setCallbacks(this->featureCallbacks);
+    this->hid->setReportMap((uint8_t*)kHidReportDescriptorHighRes, sizeof(kHidReportDescriptorHighRes));
+  } else {
+    this->inputMouse = this->hid->getInputReport(kMouseReportId);
+    this->hid->setReportMap((uint8_t*)kHidReportDescriptor, sizeof(kHidReportDescriptor));
+  }
+  this->inputKeyboard = this->hid->getInputReport(kKeyboardReportId);
+  this->outputKeyboard = this->hid->getOutputReport(kKeyboardReportId);
+  const uint8_t leds = 0;
+  this->outputKeyboard->setValue(&leds, sizeof(leds));
+  this->inputConsumer = this->hid->getInputReport(kConsumerReportId);
   this->hid->startServices();
   this->hid->setBatteryLevel(this->batteryLevel);
 
   this->configureAdvertising();
   this->onStarted(this->server);
-  this->advertising->start();
+  this->reconnectStartMs = millis();
+  this->startAdvertisingPhase(BleMouseAdvPhase::Directed);
 }
 
 void BleMouse::end(void) {}
@@ -131,33 +475,351 @@ void BleMouse::configureAdvertising() {
   this->advertising->setName(this->deviceName);
   this->advertising->enableScanResponse(true);
   this->advertising->setPreferredParams(kConnMinInterval, kConnMaxInterval);
+  this->advertising->setAdvertisingCompleteCallback([this](NimBLEAdvertising*) { this->onAdvertisingComplete(); });
+}
+
+// Application task only. Stops whatever is advertising and starts `phase`. Directed and whitelisted phases need a
+// selected host that is still bonded; without one this falls through to Open.
+bool BleMouse::startAdvertisingPhase(BleMouseAdvPhase phase) {
+  if (this->advertising == nullptr) {
+    return false;
+  }
+  this->advRequested = false;  // Superseded: a phase the host task posted earlier is now stale
+  const NimBLEAddress host = this->hostAddress(this->hostSlot);
+  if (!this->hasHost(this->hostSlot) || !NimBLEDevice::isBonded(host)) {
+    phase = BleMouseAdvPhase::Open;
+  }
+  this->advertising->stop();
+  if (!this->whitelisted.isNull()) {
+    NimBLEDevice::whiteListRemove(this->whitelisted);
+    this->whitelisted = NimBLEAddress();
+  }
+  this->advPhase = phase;
+  switch (phase) {
+    case BleMouseAdvPhase::Directed:
+      this->advertising->setConnectableMode(BLE_GAP_CONN_MODE_DIR);
+      this->advertising->setScanFilter(false, false);
+      this->advertising->setMinInterval(kFastAdvMinInterval);
+      this->advertising->setMaxInterval(kFastAdvMaxInterval);
+      if (this->advertising->start(kDirectedAdvMs, &host)) {
+        return true;
+      }
+      return this->startAdvertisingPhase(BleMouseAdvPhase::Whitelist);
+    case BleMouseAdvPhase::Whitelist:
+      this->advertising->setConnectableMode(BLE_GAP_CONN_MODE_UND);
+      if (NimBLEDevice::whiteListAdd(host)) {
+        this->whitelisted = host;
+        this->advertising->setScanFilter(false, true);
+        this->advertising->setMinInterval(kFastAdvMinInterval);
+        this->advertising->setMaxInterval(kFastAdvMaxInterval);
+        if (this->advertising->start(kWhitelistAdvMs)) {
+          return true;
+        }
+      }
+      return this->startAdvertisingPhase(BleMouseAdvPhase::Open);
+    default:
+      this->advPhase = BleMouseAdvPhase::Open;
+      this->advertising->setConnectableMode(BLE_GAP_CONN_MODE_UND);
+      this->advertising->setScanFilter(false, false);
+      this->advertising->setMinInterval(0);  // Stack defaults
+      this->advertising->setMaxInterval(0);
+      return this->advertising->start();
+  }
+}
+
+// NimBLE host task: hands the phase to service() instead of touching the advertiser here, where
+// it would race begin()/selectHostSlot()/startPairingMode() on the application task.
+void BleMouse::requestAdvertisingPhase(BleMouseAdvPhase phase) {
+  this->advRequestPhase = phase;
+  this->advRequested = true;
+}
+
+// NimBLE host task: a timed phase ran out without a connection.
+void BleMouse::onAdvertisingComplete() {
+  if (this->connected) {
+    this->advPhase = BleMouseAdvPhase::Off;
+    return;
+  }
+  this->requestAdvertisingPhase(this->advPhase == BleMouseAdvPhase::Directed ? BleMouseAdvPhase::Whitelist
+                                                                             : BleMouseAdvPhase::Open);
+}
+
+// NimBLE host task, after pairing or re-encryption with a bonded host. A known host becomes the
+// selected slot; a new one takes the selected slot if it is free, else the first free slot,
+// else replaces the selected slot's host.
+void BleMouse::storeBondedHost(const NimBLEAddress& address) {
+  uint8_t slot = BLE_MOUSE_HOST_SLOTS;
+  for (uint8_t i = 0; i < BLE_MOUSE_HOST_SLOTS; ++i) {
+    if (this->hasHost(i) && this->hostAddress(i) == address) {
+      slot = i;
+      break;
+    }
+  }
+  if (slot == BLE_MOUSE_HOST_SLOTS) {
+    slot = this->hostSlot;
+    for (uint8_t i = 0; i < BLE_MOUSE_HOST_SLOTS && this->hasHost(slot); ++i) {
+      slot = this->hasHost(i) ? slot : i;
+    }
+    if (this->hasHost(slot)) {
+      NimBLEDevice::deleteBond(this->hostAddress(slot));
+    }
+    memcpy(this->hosts[slot].address, address.getVal(), sizeof(this->hosts[slot].address));
+    this->hosts[slot].type = address.getType();
+  } else if (slot == this->hostSlot) {
+    return;
+  }
+  this->hostSlot = slot;
+  ++this->hostsRevision;
+}
+
+NimBLEAddress BleMouse::hostAddress(uint8_t slot) const {
+  return NimBLEAddress(this->hosts[slot].address, this->hosts[slot].type);
+}
+
+bool BleMouse::hasHost(uint8_t slot) const {
+  if (slot >= BLE_MOUSE_HOST_SLOTS) {
+    return false;
+  }
+  for (size_t i = 0; i < sizeof(this->hosts[slot].address); ++i) {
+    if (this->hosts[slot].address[i] != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+BleMouseHost BleMouse::getHost(uint8_t slot) const {
+  BleMouseHost host = {};
+  if (slot < BLE_MOUSE_HOST_SLOTS) {
+    host = this->hosts[slot];
+  }
+  return host;
+}
+
+void BleMouse::restoreHosts(const BleMouseHost* saved, size_t count, uint8_t selected) {
+  for (size_t i = 0; i < BLE_MOUSE_HOST_SLOTS; ++i) {
+    if (i < count) {
+      this->hosts[i] = saved[i];
+    } else {
+      memset(&this->hosts[i], 0, sizeof(this->hosts[i]));
+    }
+  }
+  this->hostSlot = (selected < BLE_MOUSE_HOST_SLOTS) ? selected : 0;
+}
+
+bool BleMouse::selectHostSlot(uint8_t slot) {
+  if (slot >= BLE_MOUSE_HOST_SLOTS) {
+    return false;
+  }
+  if (slot == this->hostSlot) {
+    return true;
+  }
+  this->hostSlot = slot;
+  ++this->hostsRevision;
+  if (this->server == nullptr || this->advertising == nullptr) {
+    return true;
+  }
+  this->reconnectStartMs = millis();
+  if (this->isConnected()) {
+    // onDisconnect starts advertising to the newly selected host.
+    auto peers = this->server->getPeerDevices();
+    for (size_t i = 0; i < peers.size(); ++i) {
+      this->server->disconnect(peers[i]);
+    }
+  } else {
+    this->startAdvertisingPhase(BleMouseAdvPhase::Directed);
+  }
+  return true;
 }
 
 void BleMouse::click(uint8_t b) {
-  _buttons = b;
-  move(0, 0, 0, 0);
-  _buttons = 0;
-  move(0, 0, 0, 0);
+  press(b);
+  release(b);
+}
+
+void BleMouse::setReportMode(BleMouseReportMode mode) {
+  if (this->hid == nullptr) {
+    this->reportMode = mode;
+  }
 }
 
 void BleMouse::move(signed char x, signed char y, signed char wheel, signed char hWheel) {
-  if (this->isConnected() && this->inputMouse != nullptr) {
-    uint8_t m[5];
-    m[0] = _buttons;
+  addPending(x, y, wheel * MOUSE_WHEEL_RESOLUTION, hWheel * MOUSE_WHEEL_RESOLUTION);
+}
+
+void BleMouse::moveHighRes(int16_t x, int16_t y, int16_t wheel, int16_t hWheel) {
+  addPending(x, y, wheel, hWheel);
+}
+
+void BleMouse::addPending(int32_t x, int32_t y, int32_t wheel, int32_t hWheel) {
+  if (!this->isConnected() || this->inputMouse == nullptr) {
+    return;
+  }
+  if (x == 0 && y == 0 && wheel == 0 && hWheel == 0) {
+    return;
+  }
+  if (this->pendingReport) {
+    ++this->stats.merged;
+  }
+  this->pendingX += x;
+  this->pendingY += y;
+  this->pendingWheel += wheel;
+  this->pendingHWheel += hWheel;
+  bool clamped = clampPending(this->pendingX);
+  clamped |= clampPending(this->pendingY);
+  clamped |= clampPending(this->pendingWheel);
+  clamped |= clampPending(this->pendingHWheel);
+  if (clamped) {
+    ++this->stats.clamped;
+  }
+  this->pendingReport = this->pendingReport || this->hasReportableMotion();
+  this->service();
+}
+
+void BleMouse::service(void) {
+  if (this->disconnectPending) {
+    this->disconnectPending = false;
+    this->buttonQueued = 0;
+    this->clearKeyReports();
+  }
+  if (this->advRequested) {
+    if (this->connected) {
+      this->advRequested = false;
+      this->advPhase = BleMouseAdvPhase::Off;
+    } else {
+      this->startAdvertisingPhase(this->advRequestPhase);
+    }
+  }
+  if (this->pairingPending && millis() - this->pairingRequestMs >= kPairingDisconnectWaitMs) {
+    this->openPairingAdvertising();
+  }
+  if ((this->keyboardQueue.count > 0 || this->consumerQueue.count > 0) &&
+      micros() - this->lastKeyResendUs >= this->connIntervalUs) {
+    this->lastKeyResendUs = micros();
+    this->flushKeyQueue(this->inputKeyboard, sizeof(this->keyboardReport), this->keyboardQueue);
+    this->flushKeyQueue(this->inputConsumer, sizeof(this->consumerReport), this->consumerQueue);
+  }
+  if (!this->pendingReport) {
+    return;
+  }
+  if (micros() - this->lastReportUs < this->connIntervalUs) {
+    return;
+  }
+  this->sendPendingReport();
+}
+
+void BleMouse::flush(void) {
+  if (this->pendingReport) {
+    this->sendPendingReport();
+  }
+}
+
+// Sends one report carrying the oldest undelivered button state (or the current buttons) and
+// as much pending motion as fits. Anything beyond the descriptor's range stays pending for the
+// next connection event, and a failed notify (mbuf pool exhausted, link congested) puts the
+// whole report back, button state included.
+void BleMouse::sendPendingReport() {
+  if (!this->isConnected() || this->inputMouse == nullptr) {
+    this->pendingX = this->pendingY = this->pendingWheel = this->pendingHWheel = 0;
+    this->buttonQueued = 0;
+    this->pendingReport = false;
+    return;
+  }
+  const uint8_t buttons = (this->buttonQueued > 0) ? this->buttonQueue[0] : _buttons;
+  const bool highRes = (this->reportMode == BleMouseReportMode::HighRes16);
+  const int32_t limit = highRes ? 32767 : 127;
+  const int32_t wheelStep = this->wheelUnit(kWheelMultiplierBits);
+  const int32_t hWheelStep = this->wheelUnit(kHWheelMultiplierBits);
+  const int32_t x = takeReportAxis(this->pendingX, limit, 1);
+  const int32_t y = takeReportAxis(this->pendingY, limit, 1);
+  const int32_t wheel = takeReportAxis(this->pendingWheel, limit, wheelStep);
+  const int32_t hWheel = takeReportAxis(this->pendingHWheel, limit, hWheelStep);
+  if (highRes) {
+    uint8_t m[kMouseHighResReportBytes];
+    m[0] = buttons;
+    putLe16(m + 1, x);
+    putLe16(m + 3, y);
+    putLe16(m + 5, wheel);
+    putLe16(m + 7, hWheel);
+    this->inputMouse->setValue(m, sizeof(m));
+  } else {
+    uint8_t m[kMouseReportBytes];
+    m[0] = buttons;
     m[1] = static_cast<uint8_t>(x);
     m[2] = static_cast<uint8_t>(y);
     m[3] = static_cast<uint8_t>(wheel);
     m[4] = static_cast<uint8_t>(hWheel);
     this->inputMouse->setValue(m, sizeof(m));
-    this->inputMouse->notify();
   }
+  this->lastReportUs = micros();
+  const bool delivered = this->inputMouse->notify();
+  if (this->reportObserver != nullptr) {
+    BleMouseSentReport report;
+    report.timeUs = this->lastReportUs;
+    report.buttons = buttons;
+    report.x = static_cast<int16_t>(x);
+    report.y = static_cast<int16_t>(y);
+    report.wheel = static_cast<int16_t>(wheel);
+    report.hWheel = static_cast<int16_t>(hWheel);
+    report.delivered = delivered;
+    this->reportObserver(report, this->reportObserverContext);
+  }
+  if (!delivered) {
+    this->pendingX += x;
+    this->pendingY += y;
+    this->pendingWheel += wheel * wheelStep;
+    this->pendingHWheel += hWheel * hWheelStep;
+    this->pendingReport = true;
+    this->lastNotifyFailed = true;
+    ++this->stats.dropped;
+    return;
+  }
+  ++this->stats.sent;
+  if (this->lastNotifyFailed) {
+    this->lastNotifyFailed = false;
+    ++this->stats.retried;
+  }
+  if (this->buttonQueued > 0) {
+    --this->buttonQueued;
+    memmove(this->buttonQueue, this->buttonQueue + 1, this->buttonQueued);
+  }
+  // Further queued edges go out one per connection interval from service().
+  this->pendingReport = this->hasReportableMotion() || this->buttonQueued > 0;
+}
+
+// Without an active Resolution Multiplier the host counts whole detents.
+int32_t BleMouse::wheelUnit(uint8_t multiplierBits) const {
+  const bool hiResWheel = (this->reportMode == BleMouseReportMode::HighRes16) &&
+                          (this->wheelMultiplier & multiplierBits) != 0;
+  return hiResWheel ? 1 : MOUSE_WHEEL_RESOLUTION;
 }
 
+// Sub-detent wheel fractions wait for more scrolling instead of forcing empty reports.
+bool BleMouse::hasReportableMotion() const {
+  return this->pendingX != 0 || this->pendingY != 0 ||
+         this->pendingWheel / this->wheelUnit(kWheelMultiplierBits) != 0 ||
+         this->pendingHWheel / this->wheelUnit(kHWheelMultiplierBits) != 0;
+}
+
+// Button edges are queued and the oldest goes out immediately, carrying any motion merged so
+// far. A press followed by a release inside one interval, or behind a failed notify, still
+// reaches the host as two reports.
 void BleMouse::buttons(uint8_t b) {
-  if (b != _buttons) {
-    _buttons = b;
-    move(0, 0, 0, 0);
+  if (b == _buttons) {
+    return;
   }
+  _buttons = b;
+  if (this->buttonQueued < MOUSE_BUTTON_QUEUE_DEPTH) {
+    this->buttonQueue[this->buttonQueued++] = b;
+  } else {
+    // The link has been stuck for several clicks: the newest state replaces the last queued one.
+    this->buttonQueue[MOUSE_BUTTON_QUEUE_DEPTH - 1] = b;
+  }
+  if (this->pendingReport) {
+    ++this->stats.forced;
+  }
+  this->pendingReport = true;
+  this->sendPendingReport();
 }
 
 void BleMouse::press(uint8_t b) {
@@ -172,6 +834,166 @@ bool BleMouse::isPressed(uint8_t b) {
   return (b & _buttons) > 0;
 }
 
+// Queues a copy of the report as it is now and sends whatever the queue holds, oldest first.
+void BleMouse::sendKeyReport(NimBLECharacteristic* input, const uint8_t* report, size_t length,
+                             KeyReportQueue& queue) {
+  if (!this->isConnected() || input == nullptr) {
+    queue.count = 0;
+    return;
+  }
+  if (queue.count == BLE_KEY_QUEUE_DEPTH) {
+    // Stuck for several taps: the newest state replaces the last queued one.
+    --queue.count;
+    ++this->stats.keyOverflow;
+  }
+  memcpy(queue.reports[queue.count++], report, length);
+  this->flushKeyQueue(input, length, queue);
+}
+
+// Stops at the first failed notify; service() retries from there after a connection interval.
+void BleMouse::flushKeyQueue(NimBLECharacteristic* input, size_t length, KeyReportQueue& queue) {
+  if (!this->isConnected() || input == nullptr) {
+    queue.count = 0;
+    return;
+  }
+  while (queue.count > 0) {
+    input->setValue(queue.reports[0], length);
+    if (!input->notify()) {
+      ++this->stats.keyDropped;
+      this->lastKeyResendUs = micros();
+      return;
+    }
+    ++this->stats.keySent;
+    if (queue.count == 0) {
+      return;  // Emptied underneath us; nothing left to shift
+    }
+    --queue.count;
+    memmove(queue.reports[0], queue.reports[1], queue.count * sizeof(queue.reports[0]));
+  }
+}
+
+void BleMouse::clearKeyReports() {
+  memset(this->keyboardReport, 0, sizeof(this->keyboardReport));
+  memset(this->consumerReport, 0, sizeof(this->consumerReport));
+  this->keyboardQueue.count = 0;
+  this->consumerQueue.count = 0;
+}
+
+bool BleMouse::pressKey(uint8_t usage) {
+  uint8_t* keys = this->keyboardReport + kKeyboardKeysOffset;
+  uint8_t* freeSlot = nullptr;
+  for (size_t i = 0; i < BLE_KEYBOARD_KEY_SLOTS; ++i) {
+    if (keys[i] == usage) {
+      return true;
+    }
+    if (keys[i] == 0 && freeSlot == nullptr) {
+      freeSlot = keys + i;
+    }
+  }
+  if (usage == 0 || freeSlot == nullptr) {
+    return false;
+  }
+  *freeSlot = usage;
+  this->sendKeyReport(this->inputKeyboard, this->keyboardReport, sizeof(this->keyboardReport), this->keyboardQueue);
+  return true;
+}
+
+void BleMouse::releaseKey(uint8_t usage) {
+  uint8_t* keys = this->keyboardReport + kKeyboardKeysOffset;
+  for (size_t i = 0; i < BLE_KEYBOARD_KEY_SLOTS; ++i) {
+    if (usage != 0 && keys[i] == usage) {
+      keys[i] = 0;
+      this->sendKeyReport(this->inputKeyboard, this->keyboardReport, sizeof(this->keyboardReport),
+                          this->keyboardQueue);
+      return;
+    }
+  }
+}
+
+void BleMouse::setKeyModifiers(uint8_t modifiers) {
+  if (this->keyboardReport[kKeyboardModifierOffset] != modifiers) {
+    this->keyboardReport[kKeyboardModifierOffset] = modifiers;
+    this->sendKeyReport(this->inputKeyboard, this->keyboardReport, sizeof(this->keyboardReport), this->keyboardQueue);
+  }
+}
+
+// Modifiers go down before the key and come up after it, so the host sees the chord.
+void BleMouse::tapKey(uint8_t usage, uint8_t modifiers) {
+  const uint8_t held = this->keyboardReport[kKeyboardModifierOffset];
+  this->setKeyModifiers(held | modifiers);
+  if (this->pressKey(usage)) {
+    this->releaseKey(usage);
+  }
+  this->setKeyModifiers(held);
+}
+
+void BleMouse::releaseAllKeys(void) {
+  static const uint8_t kNoKeys[BLE_KEYBOARD_REPORT_BYTES] = {};
+  if (memcmp(this->keyboardReport, kNoKeys, sizeof(kNoKeys)) != 0) {
+    memset(this->keyboardReport, 0, sizeof(this->keyboardReport));
+    this->sendKeyReport(this->inputKeyboard, this->keyboardReport, sizeof(this->keyboardReport), this->keyboardQueue);
+  }
+}
+
+void BleMouse::pressConsumer(uint16_t usage) {
+  putLe16(this->consumerReport, usage);
+  this->sendKeyReport(this->inputConsumer, this->consumerReport, sizeof(this->consumerReport), this->consumerQueue);
+}
+
+void BleMouse::releaseConsumer(void) {
+  if (this->consumerReport[0] != 0 || this->consumerReport[1] != 0) {
+    this->pressConsumer(0);
+  }
+}
+
+void BleMouse::tapConsumer(uint16_t usage) {
+  this->pressConsumer(usage);
+  this->releaseConsumer();
+}
+
+void BleMouse::setReportObserver(BleMouseReportObserver observer, void* context) {
+  this->reportObserver = observer;
+  this->reportObserverContext = context;
+}
+
+void BleMouse::requestLinkParams(uint16_t handle) {
+  if (this->server == nullptr) {
+    return;
+  }
+  const bool idle = (this->linkProfile == BleMouseLinkProfile::Idle);
+  this->linkRequestUs = micros();
+  this->linkRequestPending = true;
+  ++this->linkStats.requests;
+  this->server->updateConnParams(handle,
+                                 idle ? kIdleConnMinInterval : kConnMinInterval,
+                                 idle ? kIdleConnMaxInterval : kConnMaxInterval,
+                                 idle ? kIdleConnLatency : kConnLatency,
+                                 kConnTimeout);
+}
+
+bool BleMouse::setLinkProfile(BleMouseLinkProfile profile) {
+  if (profile == this->linkProfile) {
+    return false;
+  }
+  this->linkProfile = profile;
+  if (!this->isConnected()) {
+    return false;
+  }
+  if (profile == BleMouseLinkProfile::Fast) {
+    // Whatever is pending goes out on the next event the idle link offers.
+    this->flush();
+  }
+  this->requestLinkParams(this->connHandle);
+  return true;
+}
+
+BleMouseLinkStats BleMouse::getLinkStats(void) const {
+  BleMouseLinkStats out = this->linkStats;
+  out.intervalUs = this->connIntervalUs;
+  out.peripheralLatency = this->connLatency;
+  return out;
+}
+
 bool BleMouse::isConnected(void) {
   return this->connected;
 }
@@ -181,21 +1003,34 @@ bool BleMouse::startPairingMode(void) {
     return false;
   }
 
+  // Forget the slot first, so the disconnect below cannot end in a reconnect to the same host.
+  if (this->hasHost(this->hostSlot)) {
+    NimBLEDevice::deleteBond(this->hostAddress(this->hostSlot));
+    memset(&this->hosts[this->hostSlot], 0, sizeof(this->hosts[this->hostSlot]));
+    ++this->hostsRevision;
+  }
+
+  if (this->server->getConnectedCount() == 0) {
+    return this->openPairingAdvertising();
+  }
+  // With the slot empty, onDisconnect falls through to open advertising; service() forces it
+  // if the host has not let go after kPairingDisconnectWaitMs.
+  this->pairingRequestMs = millis();
+  this->pairingPending = true;
   auto peers = this->server->getPeerDevices();
   for (size_t i = 0; i < peers.size(); ++i) {
     this->server->disconnect(peers[i]);
   }
+  return true;
+}
 
-  const uint32_t waitStart = millis();
-  while (this->server->getConnectedCount() > 0 && millis() - waitStart < kPairingDisconnectWaitMs) {
-    delay(10);
-  }
+bool BleMouse::openPairingAdvertising() {
+  this->pairingPending = false;
   this->connected = (this->server->getConnectedCount() > 0);
-
   this->advertising->stop();
-  NimBLEDevice::deleteAllBonds();
   this->configureAdvertising();
-  return this->advertising->start();
+  this->reconnectStartMs = millis();
+  return this->startAdvertisingPhase(BleMouseAdvPhase::Open);
 }
 
 void BleMouse::setBatteryLevel(uint8_t level) {
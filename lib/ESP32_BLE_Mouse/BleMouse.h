@@ -15,34 +15,255 @@
 #define MOUSE_FORWARD 16
 #define MOUSE_ALL (MOUSE_LEFT | MOUSE_RIGHT | MOUSE_MIDDLE)
 
+// Wheel units per detent for moveHighRes().
+#define MOUSE_WHEEL_RESOLUTION 8
+
+// Button states waiting for a delivered notify; enough for a few clicks through a congested link.
+#define MOUSE_BUTTON_QUEUE_DEPTH 8
+
+// Keyboard report: modifier bits, a reserved byte, then the held keys.
+#define BLE_KEYBOARD_KEY_SLOTS 6
+#define BLE_KEYBOARD_REPORT_BYTES 8
+#define BLE_CONSUMER_REPORT_BYTES 2
+// Key report edges waiting for a delivered notify; a chorded tap is four edges.
+#define BLE_KEY_QUEUE_DEPTH 8
+
+// Modifier bits for pressKey()/tapKey().
+#define KEYBOARD_MOD_LEFT_CTRL 0x01
+#define KEYBOARD_MOD_LEFT_SHIFT 0x02
+#define KEYBOARD_MOD_LEFT_ALT 0x04
+#define KEYBOARD_MOD_LEFT_GUI 0x08
+
+// Keyboard/Keypad page usages.
+#define KEYBOARD_B 0x05
+#define KEYBOARD_L 0x0f
+#define KEYBOARD_ENTER 0x28
+#define KEYBOARD_ESCAPE 0x29
+#define KEYBOARD_F5 0x3e
+#define KEYBOARD_PAGE_UP 0x4b
+#define KEYBOARD_PAGE_DOWN 0x4e
+#define KEYBOARD_RIGHT_ARROW 0x4f
+#define KEYBOARD_LEFT_ARROW 0x50
+#define KEYBOARD_DOWN_ARROW 0x51
+#define KEYBOARD_UP_ARROW 0x52
+
+// Consumer page usages for pressConsumer()/tapConsumer().
+#define CONSUMER_PLAY_PAUSE 0x00cd
+#define CONSUMER_MUTE 0x00e2
+#define CONSUMER_VOLUME_UP 0x00e9
+#define CONSUMER_VOLUME_DOWN 0x00ea
+
+// Bonded hosts remembered for fast reconnect; the selected one is advertised to first.
+#define BLE_MOUSE_HOST_SLOTS 3
+
+// Either way the device is a composite: mouse (report ID 1), keyboard (2), consumer control (3).
+enum class BleMouseReportMode : uint8_t {
+  Legacy8,    // 8-bit X/Y/wheel/pan mouse report; accepted by every host
+  HighRes16,  // 16-bit X/Y plus Resolution Multiplier wheel/pan
+};
+
+enum class BleMouseLinkProfile : uint8_t {
+  Fast,  // 7.5-11.25 ms, no peripheral latency: lowest input lag
+  Idle,  // 45-60 ms with peripheral latency 4: the radio sleeps while nothing moves
+};
+
+struct BleMouseLinkStats {
+  uint32_t intervalUs;        // Interval currently in use
+  uint16_t peripheralLatency; // Connection events the device may skip
+  uint32_t requests;          // Parameter update requests sent
+  uint32_t updates;           // Parameter updates applied by the controller
+  uint32_t lastUpdateUs;      // Request-to-applied time of the most recent update
+};
+
+struct BleMouseReportStats {
+  uint32_t sent;    // notifications handed to the stack
+  uint32_t merged;  // move()/moveHighRes() calls folded into an already pending report
+  uint32_t forced;  // reports flushed early by a button edge
+  uint32_t dropped; // notify() failures; their motion was folded back into the pending report
+  uint32_t retried; // successful sends that followed a failure
+  uint32_t clamped; // times the pending motion hit its bound while the link was congested
+  uint32_t keySent;    // keyboard and consumer-control notifications handed to the stack
+  uint32_t keyDropped; // keyboard and consumer-control notify() failures (resent by service())
+  uint32_t keyOverflow; // key edges merged because the queue was full
+};
+
+// How the device is advertising while disconnected. After a disconnect (and at begin()) it
+// runs Directed -> Whitelist -> Open for the selected slot's host; a slot without a bonded
+// host starts at Open.
+enum class BleMouseAdvPhase : uint8_t {
+  Off,        // Connected, or begin() not called yet
+  Directed,   // Directed advertising to the selected host only
+  Whitelist,  // Undirected, but only the selected host may connect
+  Open,       // Undirected: any bonded host, or a new one to pair
+};
+
+// A bonded host's identity address, in a form the application can persist.
+struct BleMouseHost {
+  uint8_t address[6];  // NimBLE byte order; all zero for an empty slot
+  uint8_t type;        // BLE_ADDR_PUBLIC or BLE_ADDR_RANDOM
+};
+
+struct BleMouseReconnectStats {
+  uint32_t lastMs;              // Disconnect (or begin()) to connected, most recent connection
+  BleMouseAdvPhase lastPhase;   // Phase that was running when that host connected
+  uint32_t connections;
+};
+
+// One input report as handed to notify(); wheel/hWheel are in the units the host expects.
+struct BleMouseSentReport {
+  uint32_t timeUs;
+  uint8_t buttons;
+  int16_t x;
+  int16_t y;
+  int16_t wheel;
+  int16_t hWheel;
+  bool delivered;  // false when notify() failed and the motion was folded back
+};
+
+typedef void (*BleMouseReportObserver)(const BleMouseSentReport& report, void* context);
+
 class BleMouse {
 private:
   uint8_t _buttons;
+  // Every button edge is queued and sent in order, one report each, so a failed press notify
+  // cannot be overtaken by the release that follows it.
+  uint8_t buttonQueue[MOUSE_BUTTON_QUEUE_DEPTH];
+  uint8_t buttonQueued;
   NimBLEHIDDevice* hid;
   NimBLECharacteristic* inputMouse;
+  NimBLECharacteristic* featureMouse;
+  NimBLECharacteristic* inputKeyboard;
+  NimBLECharacteristic* outputKeyboard;  // LED state from the host; accepted and ignored
+  NimBLECharacteristic* inputConsumer;
   NimBLEServer* server;
   NimBLEAdvertising* advertising;
   bool connected;
+  BleMouseReportMode reportMode;
+  uint8_t wheelMultiplier;  // Resolution Multiplier feature byte last written by the host
+  // Pending report: motion is accumulated here and sent at most once per connection interval.
+  int32_t pendingX;
+  int32_t pendingY;
+  int32_t pendingWheel;   // in 1/MOUSE_WHEEL_RESOLUTION detents
+  int32_t pendingHWheel;  // in 1/MOUSE_WHEEL_RESOLUTION detents
+  bool pendingReport;
+  uint32_t lastReportUs;
+  uint32_t connIntervalUs;
+  uint16_t connHandle;
+  uint16_t connLatency;
+  BleMouseLinkProfile linkProfile;
+  uint32_t linkRequestUs;
+  bool linkRequestPending;
+  BleMouseLinkStats linkStats;
+  bool lastNotifyFailed;
+  BleMouseReportStats stats;
+  BleMouseReportObserver reportObserver;
+  void* reportObserverContext;
+  // Key reports are encoded in place: an edge edits a byte and a copy of the buffer is queued.
+  // Copies leave the queue only once notify() accepted them, so a tap whose press failed is
+  // resent as press then release rather than as the released state alone.
+  struct KeyReportQueue {
+    uint8_t reports[BLE_KEY_QUEUE_DEPTH][BLE_KEYBOARD_REPORT_BYTES];
+    uint8_t count;
+  };
+  uint8_t keyboardReport[BLE_KEYBOARD_REPORT_BYTES];
+  uint8_t consumerReport[BLE_CONSUMER_REPORT_BYTES];
+  KeyReportQueue keyboardQueue;
+  KeyReportQueue consumerQueue;
+  uint32_t lastKeyResendUs;
+  // Host slots are written by the NimBLE host task and read by the application: word-sized
+  // fields, and hostsRevision is bumped after every change.
+  BleMouseHost hosts[BLE_MOUSE_HOST_SLOTS];
+  uint8_t hostSlot;
+  volatile uint32_t hostsRevision;
+  NimBLEAddress whitelisted;  // Entry this device added to the controller whitelist
+  volatile BleMouseAdvPhase advPhase;
+  // Phase changes the NimBLE host task asks for; service() starts them, so only the application
+  // task ever reconfigures the advertiser. Written phase first, then the flag.
+  volatile BleMouseAdvPhase advRequestPhase;
+  volatile bool advRequested;
+  // Set by onDisconnect; service() drops the queued button edges, held keys and queued key
+  // reports on the application task, which is the only task that touches those queues.
+  volatile bool disconnectPending;
+  uint32_t reconnectStartMs;
+  BleMouseReconnectStats reconnectStats;
+  volatile bool pairingPending;  // Waiting for the old host to disconnect; cleared by onDisconnect
+  uint32_t pairingRequestMs;
   void buttons(uint8_t b);
   void configureAdvertising();
+  bool startAdvertisingPhase(BleMouseAdvPhase phase);
+  void requestAdvertisingPhase(BleMouseAdvPhase phase);
+  bool openPairingAdvertising();
+  void onAdvertisingComplete();
+  void storeBondedHost(const NimBLEAddress& address);
+  NimBLEAddress hostAddress(uint8_t slot) const;
+  void requestLinkParams(uint16_t handle);
+  void addPending(int32_t x, int32_t y, int32_t wheel, int32_t hWheel);
+  int32_t wheelUnit(uint8_t multiplierBits) const;
+  bool hasReportableMotion() const;
+  void sendPendingReport();
+  void sendKeyReport(NimBLECharacteristic* input, const uint8_t* report, size_t length, KeyReportQueue& queue);
+  void flushKeyQueue(NimBLECharacteristic* input, size_t length, KeyReportQueue& queue);
+  void clearKeyReports();
 public:
   BleMouse(std::string deviceName = "ESP32 Bluetooth Mouse", std::string deviceManufacturer = "Espressif", uint8_t batteryLevel = 100);
   void begin(void);
   void end(void);
   void click(uint8_t b = MOUSE_LEFT);
   void move(signed char x, signed char y, signed char wheel = 0, signed char hWheel = 0);
+  // Wide-range variant: wheel/hWheel are in 1/MOUSE_WHEEL_RESOLUTION detents. Works in either
+  // report mode; larger values are spread over as many reports as the active descriptor needs.
+  void moveHighRes(int16_t x, int16_t y, int16_t wheel = 0, int16_t hWheel = 0);
+  void setReportMode(BleMouseReportMode mode);  // call before begin()
+  BleMouseReportMode getReportMode(void) const { return reportMode; }
   void press(uint8_t b = MOUSE_LEFT);   // press LEFT by default
   void release(uint8_t b = MOUSE_LEFT); // release LEFT by default
   bool isPressed(uint8_t b = MOUSE_LEFT); // check LEFT by default
+  // Keyboard: up to BLE_KEYBOARD_KEY_SLOTS keys held at once; every change is sent right away.
+  bool pressKey(uint8_t usage);  // false when every slot is taken
+  void releaseKey(uint8_t usage);
+  void setKeyModifiers(uint8_t modifiers);  // KEYBOARD_MOD_* bits
+  void tapKey(uint8_t usage, uint8_t modifiers = 0);
+  void releaseAllKeys(void);
+  // Consumer control: one usage held at a time.
+  void pressConsumer(uint16_t usage);
+  void releaseConsumer(void);
+  void tapConsumer(uint16_t usage);
+  void service(void);  // call often; flushes the pending report once per connection interval
+  void flush(void);    // send the pending report now
   bool isConnected(void);
+  BleMouseReportStats getReportStats(void) const { return stats; }
+  // Requests the connection parameters for the profile now (if connected) and on every later
+  // connection. Returns true when a request was sent.
+  bool setLinkProfile(BleMouseLinkProfile profile);
+  BleMouseLinkProfile getLinkProfile(void) const { return linkProfile; }
+  BleMouseLinkStats getLinkStats(void) const;
+  // Called from the task that runs service()/flush() after every notify attempt.
+  void setReportObserver(BleMouseReportObserver observer, void* context = nullptr);
+  // Forgets the selected slot's host (its bond included) and advertises openly so a new host
+  // can pair into that slot. Other slots keep their bonds. Does not wait: a connected host is
+  // asked to disconnect and advertising opens once it has (or from service() after a timeout).
   bool startPairingMode(void);
+  bool isPairingPending(void) const { return pairingPending; }
+  // Call before begin() with the slots saved from getHost()/getHostSlot().
+  void restoreHosts(const BleMouseHost* saved, size_t count, uint8_t selected);
+  // Makes `slot` the host to reconnect to; drops a connection to any other host. Returns false
+  // for an out-of-range slot.
+  bool selectHostSlot(uint8_t slot);
+  uint8_t getHostSlot(void) const { return hostSlot; }
+  BleMouseHost getHost(uint8_t slot) const;
+  bool hasHost(uint8_t slot) const;
+  uint32_t getHostsRevision(void) const { return hostsRevision; }  // Changes when a slot or the selection does
+  BleMouseAdvPhase getAdvPhase(void) const { return advPhase; }
+  BleMouseReconnectStats getReconnectStats(void) const { return reconnectStats; }
   void setBatteryLevel(uint8_t level);
   uint8_t batteryLevel;
   std::string deviceManufacturer;
   std::string deviceName;
 protected:
   class ServerCallbacks;
+  class FeatureCallbacks;
   ServerCallbacks* callbacks;
+  FeatureCallbacks* featureCallbacks;
   virtual void onStarted(NimBLEServer* pServer) { };
 };
 
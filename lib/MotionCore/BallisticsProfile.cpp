@@ -0,0 +1,103 @@
+#include "BallisticsProfile.h"
+
+#include "FastMath.h"
+
+namespace {
+struct BallisticsSpec {
+  const char* name;
+  float sensitivityX;
+  float sensitivityY;
+  float predictionHorizonMs;
+  float curveGain;
+  float refDps;
+  float exponent;
+};
+
+constexpr BallisticsSpec kSpecs[kBallisticsProfileCount] = {
+  {"NORMAL", 46.0f, 38.0f, 0.0f, 0.28f, 120.0f, 1.35f},
+  {"PRESENT", 32.0f, 27.0f, 0.0f, 0.45f, 160.0f, 1.60f},
+  {"CAD", 26.0f, 22.0f, 0.0f, 0.10f, 200.0f, 1.00f},
+  {"WALL", 50.0f, 42.0f, 8.0f, 1.60f, 180.0f, 1.80f},
+};
+
+constexpr int kSegments = BallisticsProfile::kSegments;
+
+constexpr double exactGain(size_t p, double norm) {
+  return 1.0 + kSpecs[p].curveGain * constexprPow(norm, kSpecs[p].exponent);
+}
+
+constexpr float gainEntry(size_t p, int i) {
+  return static_cast<float>(exactGain(p, static_cast<double>(i) / kSegments));
+}
+
+#define BALLISTICS_GAIN_ROW(p, i) gainEntry(p, i), gainEntry(p, i + 1), gainEntry(p, i + 2), gainEntry(p, i + 3)
+#define BALLISTICS_PROFILE_ROW(p)                                                                   \
+  {                                                                                                 \
+    kSpecs[p].name, kSpecs[p].sensitivityX, kSpecs[p].sensitivityY, kSpecs[p].predictionHorizonMs, \
+        kSegments / kSpecs[p].refDps, {                                                             \
+      BALLISTICS_GAIN_ROW(p, 0), BALLISTICS_GAIN_ROW(p, 4), BALLISTICS_GAIN_ROW(p, 8),              \
+      BALLISTICS_GAIN_ROW(p, 12), BALLISTICS_GAIN_ROW(p, 16), BALLISTICS_GAIN_ROW(p, 20),           \
+      BALLISTICS_GAIN_ROW(p, 24), BALLISTICS_GAIN_ROW(p, 28), gainEntry(p, kSegments)               \
+    }                                                                                               \
+  }
+}  // namespace
+
+constexpr BallisticsProfile kBallisticsProfiles[kBallisticsProfileCount] = {
+  BALLISTICS_PROFILE_ROW(0),
+  BALLISTICS_PROFILE_ROW(1),
+  BALLISTICS_PROFILE_ROW(2),
+  BALLISTICS_PROFILE_ROW(3),
+};
+#undef BALLISTICS_PROFILE_ROW
+#undef BALLISTICS_GAIN_ROW
+
+namespace {
+constexpr double absd(double v) {
+  return v < 0.0 ? -v : v;
+}
+
+constexpr double maxd(double a, double b) {
+  return a > b ? a : b;
+}
+
+// Interpolation error at eighth points of every segment, against the exact gain.
+constexpr double segmentError(size_t p, int i, int eighth) {
+  return absd(kBallisticsProfiles[p].gain[i] +
+              (kBallisticsProfiles[p].gain[i + 1] - kBallisticsProfiles[p].gain[i]) * (eighth / 8.0) -
+              exactGain(p, (i + eighth / 8.0) / kSegments));
+}
+
+constexpr double maxSegmentError(size_t p, int i, int eighth) {
+  return eighth > 7 ? 0.0 : maxd(segmentError(p, i, eighth), maxSegmentError(p, i, eighth + 1));
+}
+
+constexpr double maxTableError(size_t p, int i) {
+  return i >= kSegments ? 0.0 : maxd(maxSegmentError(p, i, 1), maxTableError(p, i + 1));
+}
+
+static_assert(absd(constexprPow(0.5, 2.0) - 0.25) < 1e-12, "constexpr pow self-check");
+static_assert(absd(constexprPow(2.0, 0.5) - 1.41421356237) < 1e-10, "constexpr pow self-check");
+static_assert(absd(constexprLog(1.0 / 32.0) + 5.0 * 0.69314718055994531) < 1e-12, "constexpr log self-check");
+
+// Worst case is WALL (largest gain); a 1e-3 gain error is far below one count per report.
+constexpr double kMaxGainError = 1.0e-3;
+static_assert(kBallisticsProfiles[0].gain[0] == 1.0f && kBallisticsProfiles[0].gain[kSegments] == 1.28f,
+              "NORMAL must reproduce the original curve endpoints");
+static_assert(maxTableError(0, 0) < kMaxGainError, "NORMAL gain table error");
+static_assert(maxTableError(1, 0) < kMaxGainError, "PRESENT gain table error");
+static_assert(maxTableError(2, 0) < kMaxGainError, "CAD gain table error");
+static_assert(maxTableError(3, 0) < kMaxGainError, "WALL gain table error");
+}  // namespace
+
+float BallisticsProfile::gainAt(float speedDps) const {
+  const float pos = speedDps * segmentsPerDps;
+  if (pos >= static_cast<float>(kSegments)) {
+    return gain[kSegments];
+  }
+  if (pos <= 0.0f) {
+    return gain[0];
+  }
+  const int index = static_cast<int>(pos);
+  const float frac = pos - static_cast<float>(index);
+  return gain[index] + (gain[index + 1] - gain[index]) * frac;
+}
@@ -0,0 +1,30 @@
+#ifndef IMUPOINTER_BALLISTICS_PROFILE_H
+#define IMUPOINTER_BALLISTICS_PROFILE_H
+
+#include <stddef.h>
+
+// Pointer transfer function: per-axis sensitivity and a speed-dependent gain
+// 1 + curveGain * (speed / refDps)^exponent, baked at compile time into a table over
+// 0..refDps (flat beyond). A profile may also opt into pointing-rate prediction. Profiles are immutable and live in flash, so the firmware switches
+// between them by swapping a pointer and the sample path only does one table lookup.
+struct BallisticsProfile {
+  static constexpr int kSegments = 32;
+
+  const char* name;        // Short label for the menu (at most 7 characters)
+  float sensitivityX;      // Counts per degree of yaw
+  float sensitivityY;      // Counts per degree of pitch
+  float predictionHorizonMs;  // Predictor lead; 0 leaves prediction off
+  float segmentsPerDps;    // kSegments / refDps
+  float gain[kSegments + 1];
+
+  // Gain for a pointing speed in deg/s: one linear interpolation.
+  float gainAt(float speedDps) const;
+};
+
+// 0: NORMAL, the original tuning. 1: PRESENT, slower and steadier for slides.
+// 2: CAD, low sensitivity with an almost linear curve. 3: WALL, strong acceleration to cross
+// very large displays, and the only profile with prediction (8 ms lead) for its long sweeps.
+constexpr size_t kBallisticsProfileCount = 4;
+extern const BallisticsProfile kBallisticsProfiles[kBallisticsProfileCount];
+
+#endif  // IMUPOINTER_BALLISTICS_PROFILE_H
@@ -0,0 +1,40 @@
+#include "ButtonDebouncer.h"
+
+bool ButtonDebouncer::edge(bool pressed, uint32_t timeUs) {
+  lastRawUs_ = timeUs;
+  if (pressed == pressed_ || timeUs - changedUs_ < lockoutUs_) {
+    ++ignored_;
+    // Only the latest edge counts: a bounce that reads the new level and is followed by one
+    // reading the old level was not a transition.
+    pending_ = pressed != pressed_;
+    pendingUs_ = timeUs;
+    return false;
+  }
+  previous_ = pressed_;
+  pressed_ = pressed;
+  changedUs_ = timeUs;
+  pending_ = false;
+  return true;
+}
+
+bool ButtonDebouncer::settle(bool pressed, uint32_t nowUs) {
+  if (pressed == pressed_ || nowUs - changedUs_ < lockoutUs_ || nowUs - lastRawUs_ < lockoutUs_) {
+    return false;
+  }
+  previous_ = pressed_;
+  pressed_ = pressed;
+  // The last edge that read this level was filed as bounce; if the handler saw none (a lost
+  // interrupt), now is the best bound.
+  changedUs_ = pending_ ? pendingUs_ : nowUs;
+  pending_ = false;
+  return true;
+}
+
+void ButtonDebouncer::reset(bool pressed, uint32_t nowUs) {
+  pressed_ = pressed;
+  previous_ = pressed;
+  pending_ = false;
+  changedUs_ = nowUs;
+  lastRawUs_ = nowUs;
+  ignored_ = 0;
+}
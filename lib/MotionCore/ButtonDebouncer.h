@@ -0,0 +1,48 @@
+#ifndef IMUPOINTER_BUTTON_DEBOUNCER_H
+#define IMUPOINTER_BUTTON_DEBOUNCER_H
+
+#include <stdint.h>
+
+// Debouncer for one mechanical button driven by a pin-change interrupt. The first edge that
+// changes the level is taken at once with its own timestamp; edges in the following lockoutUs
+// are bounce and ignored. Every edge is judged by the level read in the handler rather than
+// its direction, so a glitch that is over before the handler runs changes nothing.
+//
+// A real transition that ends inside the lockout leaves the line at a level that was never
+// reported; settle() reports it once the line has been quiet for a lockout, timestamped at the
+// last edge, which read the new level.
+class ButtonDebouncer {
+ public:
+  static constexpr uint32_t kDefaultLockoutUs = 5000;
+
+  explicit ButtonDebouncer(uint32_t lockoutUs = kDefaultLockoutUs) : lockoutUs_(lockoutUs) {}
+
+  // A captured edge, in order: `pressed` is the level the interrupt read at timeUs. Returns
+  // true when it became the debounced state at timeUs.
+  bool edge(bool pressed, uint32_t timeUs);
+  // Polled with the current level. Returns true when the debounced state changed; changedUs()
+  // is then the time of the transition.
+  bool settle(bool pressed, uint32_t nowUs);
+  void reset(bool pressed, uint32_t nowUs);
+
+  bool pressed() const { return pressed_; }
+  uint32_t changedUs() const { return changedUs_; }
+  // Debounced state at timeUs, which may lie shortly before the last change (a sample that
+  // was taken before the press but is processed after it).
+  bool pressedAt(uint32_t timeUs) const {
+    return static_cast<int32_t>(timeUs - changedUs_) >= 0 ? pressed_ : previous_;
+  }
+  uint32_t ignored() const { return ignored_; }
+
+ private:
+  uint32_t lockoutUs_;
+  bool pressed_ = false;
+  bool previous_ = false;
+  bool pending_ = false;     // The latest ignored edge read the other level
+  uint32_t pendingUs_ = 0;   // and arrived then
+  uint32_t changedUs_ = 0;
+  uint32_t lastRawUs_ = 0;   // Any edge, for settle()'s quiet period
+  uint32_t ignored_ = 0;
+};
+
+#endif  // IMUPOINTER_BUTTON_DEBOUNCER_H
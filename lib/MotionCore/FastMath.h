@@ -0,0 +1,74 @@
+#ifndef IMUPOINTER_FAST_MATH_H
+#define IMUPOINTER_FAST_MATH_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Transcendental-free helpers for the per-sample motion path. powf/sqrtf/lroundf are library
+// calls on the ESP32 FPU (powf alone costs several hundred cycles); these stay in a handful of
+// multiply-adds. Error bounds are checked on the host by the native bench.
+
+// Compile-time log/exp/pow (C++11 constexpr: single-expression recursion) for building lookup
+// tables such as the ballistics gain curves. Not meant to run on the target.
+namespace fastmath_detail {
+constexpr double kLn2 = 0.69314718055994531;
+
+constexpr double square(double v) {
+  return v * v;
+}
+
+// 2 * atanh(y) = ln((1 + y) / (1 - y)); |y| <= 0.172 after range reduction.
+constexpr double atanhSeries(double y2, double term, int k) {
+  return k > 31 ? 0.0 : term / k + atanhSeries(y2, term * y2, k + 2);
+}
+
+constexpr double lnNear1(double x) {
+  return 2.0 * atanhSeries(square((x - 1.0) / (x + 1.0)), (x - 1.0) / (x + 1.0), 1);
+}
+
+constexpr double expSeries(double z, double term, int k) {
+  return k > 18 ? term : term + expSeries(z, term * z / k, k + 1);
+}
+}  // namespace fastmath_detail
+
+constexpr double constexprLog(double x) {
+  return x < 0.70710678 ? constexprLog(x * 2.0) - fastmath_detail::kLn2
+                        : (x > 1.41421356 ? constexprLog(x * 0.5) + fastmath_detail::kLn2
+                                          : fastmath_detail::lnNear1(x));
+}
+
+constexpr double constexprExp(double z) {
+  return (z > 0.5 || z < -0.5) ? fastmath_detail::square(constexprExp(z * 0.5))
+                               : fastmath_detail::expSeries(z, 1.0, 1);
+}
+
+// x^p for x >= 0.
+constexpr double constexprPow(double x, double p) {
+  return x <= 0.0 ? 0.0 : constexprExp(p * constexprLog(x));
+}
+
+// 1/sqrt(x) for x > 0: bit-level initial guess plus two Newton steps, relative error < 5e-6.
+inline float fastRsqrt(float x) {
+  uint32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  bits = 0x5F375A86u - (bits >> 1);
+  float y;
+  memcpy(&y, &bits, sizeof(y));
+  const float half = 0.5f * x;
+  y = y * (1.5f - half * y * y);
+  y = y * (1.5f - half * y * y);
+  return y;
+}
+
+// sqrt(x * x + y * y); exact 0 for a zero vector.
+inline float fastHypot(float x, float y) {
+  const float sq = x * x + y * y;
+  return (sq > 0.0f) ? sq * fastRsqrt(sq) : 0.0f;
+}
+
+// lroundf() for |value| < 2^31: rounds half away from zero using a truncating conversion.
+inline long roundToLong(float value) {
+  return static_cast<long>(value + (value >= 0.0f ? 0.5f : -0.5f));
+}
+
+#endif  // IMUPOINTER_FAST_MATH_H
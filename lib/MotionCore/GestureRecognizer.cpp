@@ -0,0 +1,220 @@
+#include "GestureRecognizer.h"
+
+#include <math.h>
+
+#include "FastMath.h"
+
+namespace {
+constexpr float kUnreached = 1.0e9f;
+// Added for every step that stretches or squeezes the template. Without it a fast stream
+// matches the whole template against a few saturated steps.
+constexpr float kWarpPenalty = 0.1f;
+constexpr float kPi = 3.14159265f;
+
+// Template shapes in deg/s; compressed like the input before use.
+constexpr size_t kFlickOutSteps = 7;     // 140 ms out
+constexpr size_t kFlickPauseSteps = 1;
+constexpr size_t kFlickReturnSteps = 12; // 240 ms back to where it started
+constexpr float kFlickPeakDps = 300.0f;
+constexpr size_t kCircleSteps = 38;      // Three quarters of a 1 s turn
+constexpr float kCircleSpeedDps = 100.0f;
+
+void compress(float& x, float& y) {
+  const float k = 1.0f / (fastHypot(x, y) + GestureRecognizer::kSoftSpeedDps);
+  x *= k;
+  y *= k;
+}
+}  // namespace
+
+const char* gestureName(Gesture gesture) {
+  switch (gesture) {
+    case Gesture::FlickLeft:
+      return "flick_left";
+    case Gesture::FlickRight:
+      return "flick_right";
+    case Gesture::Circle:
+      return "circle";
+    default:
+      return "none";
+  }
+}
+
+GestureRecognizer::GestureRecognizer(const Config& config) : config_(config) {
+  float x[kMaxTemplateSteps];
+  float y[kMaxTemplateSteps] = {};
+  size_t n = 0;
+  for (size_t i = 0; i < kFlickOutSteps; ++i) {
+    x[n++] = kFlickPeakDps * sinf(kPi * (i + 0.5f) / kFlickOutSteps);
+  }
+  for (size_t i = 0; i < kFlickPauseSteps; ++i) {
+    x[n++] = 0.0f;
+  }
+  // Same angle back: the return peak scales with the out/return duration ratio.
+  const float returnPeak = kFlickPeakDps * kFlickOutSteps / kFlickReturnSteps;
+  for (size_t i = 0; i < kFlickReturnSteps; ++i) {
+    x[n++] = -returnPeak * sinf(kPi * (i + 0.5f) / kFlickReturnSteps);
+  }
+  addTemplate(Gesture::FlickRight, config_.minFlickPeakDps, x, y, n);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = -x[i];
+  }
+  addTemplate(Gesture::FlickLeft, config_.minFlickPeakDps, x, y, n);
+
+  // A circle can start anywhere and run either way. Three-quarter-turn templates from four
+  // starting directions mean any full turn contains one of them.
+  for (int direction = -1; direction <= 1; direction += 2) {
+    for (int phase = 0; phase < 4; ++phase) {
+      for (size_t i = 0; i < kCircleSteps; ++i) {
+        const float angle = phase * 0.5f * kPi + direction * 1.5f * kPi * (i + 0.5f) / kCircleSteps;
+        x[i] = kCircleSpeedDps * cosf(angle);
+        y[i] = kCircleSpeedDps * sinf(angle);
+      }
+      addTemplate(Gesture::Circle, config_.minCirclePeakDps, x, y, kCircleSteps);
+    }
+  }
+  reset();
+}
+
+void GestureRecognizer::addTemplate(Gesture gesture, float minPeakDps, const float* x, const float* y, size_t length) {
+  if (templateCount_ >= kTemplateCount || length == 0 || length > kMaxTemplateSteps) {
+    return;
+  }
+  Template& t = templates_[templateCount_++];
+  t.gesture = gesture;
+  t.length = static_cast<uint8_t>(length);
+  t.minPeakDps = minPeakDps;
+  float energy = 0.0f;
+  for (size_t i = 0; i < length; ++i) {
+    t.x[i] = x[i];
+    t.y[i] = y[i];
+    compress(t.x[i], t.y[i]);
+    energy += t.x[i] * t.x[i] + t.y[i] * t.y[i];
+  }
+  t.invEnergy = 1.0f / energy;
+}
+
+void GestureRecognizer::reset() {
+  for (size_t i = 0; i < kWindowSteps; ++i) {
+    ringX_[i] = 0.0f;
+    ringY_[i] = 0.0f;
+  }
+  steps_ = 0;
+  refractoryUntil_ = 0;
+  accumX_ = 0.0f;
+  accumY_ = 0.0f;
+  accumT_ = 0.0f;
+  candidate_ = Gesture::None;
+  lastScore_ = 0.0f;
+  restartColumns();
+}
+
+void GestureRecognizer::restartColumns() {
+  for (size_t k = 0; k < templateCount_; ++k) {
+    Template& t = templates_[k];
+    for (size_t i = 0; i <= t.length; ++i) {
+      t.cost[i] = kUnreached;
+      t.start[i] = 0;
+    }
+  }
+}
+
+bool GestureRecognizer::spanLooksLikeGesture(uint32_t firstStep, uint32_t lastStep, float minPeakDps) const {
+  if (lastStep - firstStep >= kWindowSteps) {
+    return false;  // Older than the ring: too slow to be a gesture
+  }
+  float peak = 0.0f;
+  float path = 0.0f;
+  float netX = 0.0f;
+  float netY = 0.0f;
+  for (uint32_t s = firstStep; s != lastStep + 1; ++s) {
+    const float x = ringX_[s % kWindowSteps];
+    const float y = ringY_[s % kWindowSteps];
+    const float speed = fastHypot(x, y);
+    peak = (speed > peak) ? speed : peak;
+    path += speed;
+    netX += x;
+    netY += y;
+  }
+  return peak >= minPeakDps && fastHypot(netX, netY) <= config_.maxOpenRatio * path;
+}
+
+Gesture GestureRecognizer::update(float xDps, float yDps, float dt) {
+  if (dt <= 0.0f) {
+    return Gesture::None;
+  }
+  accumX_ += xDps * dt;
+  accumY_ += yDps * dt;
+  accumT_ += dt;
+  if (accumT_ < kStepS) {
+    return Gesture::None;
+  }
+  const float inv = 1.0f / accumT_;
+  step(accumX_ * inv, accumY_ * inv);
+  accumX_ = 0.0f;
+  accumY_ = 0.0f;
+  accumT_ = 0.0f;
+  if (steps_ < refractoryUntil_) {
+    // Matches must start after the refractory period, not in the tail of the last gesture.
+    restartColumns();
+    return Gesture::None;
+  }
+
+  if (candidate_ == Gesture::None || steps_ - 1 - candidateStep_ < config_.confirmSteps) {
+    return Gesture::None;
+  }
+  const Gesture confirmed = candidate_;
+  lastScore_ = candidateScore_;
+  candidate_ = Gesture::None;
+  refractoryUntil_ = steps_ + config_.refractorySteps;
+  restartColumns();
+  return confirmed;
+}
+
+void GestureRecognizer::step(float xDps, float yDps) {
+  const uint32_t n = steps_++;
+  ringX_[n % kWindowSteps] = xDps;
+  ringY_[n % kWindowSteps] = yDps;
+  float fx = xDps;
+  float fy = yDps;
+  compress(fx, fy);
+
+  for (size_t k = 0; k < templateCount_; ++k) {
+    Template& t = templates_[k];
+    // Row 0 is free: a match may begin at this step.
+    float diagCost = 0.0f;
+    uint32_t diagStart = n;
+    t.cost[0] = 0.0f;
+    t.start[0] = n;
+    for (size_t i = 1; i <= t.length; ++i) {
+      const float dx = fx - t.x[i - 1];
+      const float dy = fy - t.y[i - 1];
+      float best = diagCost;
+      uint32_t bestStart = diagStart;
+      if (t.cost[i] + kWarpPenalty < best) {  // Stream advanced, template held
+        best = t.cost[i] + kWarpPenalty;
+        bestStart = t.start[i];
+      }
+      if (t.cost[i - 1] + kWarpPenalty < best) {  // Template advanced, stream held
+        best = t.cost[i - 1] + kWarpPenalty;
+        bestStart = t.start[i - 1];
+      }
+      diagCost = t.cost[i];
+      diagStart = t.start[i];
+      t.cost[i] = dx * dx + dy * dy + best;
+      t.start[i] = bestStart;
+    }
+
+    const float score = t.cost[t.length] * t.invEnergy;
+    if (score > config_.matchThreshold || (candidate_ != Gesture::None && score >= candidateScore_)) {
+      continue;
+    }
+    const uint32_t first = t.start[t.length];
+    const uint32_t span = n - first + 1;
+    if (span < t.length / 2u || span > t.length * 2u || !spanLooksLikeGesture(first, n, t.minPeakDps)) {
+      continue;
+    }
+    candidate_ = t.gesture;
+    candidateScore_ = score;
+    candidateStep_ = n;
+  }
+}
@@ -0,0 +1,96 @@
+#ifndef IMUPOINTER_GESTURE_RECOGNIZER_H
+#define IMUPOINTER_GESTURE_RECOGNIZER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum class Gesture : uint8_t {
+  None,
+  FlickLeft,
+  FlickRight,
+  Circle,
+  Count,
+};
+
+constexpr size_t kGestureCount = static_cast<size_t>(Gesture::Count);
+
+const char* gestureName(Gesture gesture);
+
+// Streaming recognizer for wrist gestures in the pointing rates: a flick (quick turn out and
+// back) to either side, and a circle in either direction.
+//
+// Input rates are box-averaged into 50 Hz steps and compressed to v / (|v| + kSoftSpeedDps),
+// which keeps the direction but makes fast and slow performances of a gesture look alike.
+// Every step advances one subsequence-DTW column per template (SPRING: a match may start at any
+// step), so the cost is fixed by the template lengths and nothing is allocated. A template end
+// cell below the threshold becomes a candidate if the matched span fits the ring window,
+// reached the gesture's minimum peak speed and ended near where it started (a sweep with a
+// slow drift back is pointing); it is reported once no better match has appeared for
+// confirmSteps.
+// After a report every column restarts and a refractory period suppresses repeats.
+class GestureRecognizer {
+ public:
+  struct Config {
+    float matchThreshold = 0.25f;     // Largest DTW cost accepted, relative to the template energy
+    float minFlickPeakDps = 150.0f;   // Slower turns out and back are pointing, not a flick
+    float minCirclePeakDps = 50.0f;
+    float maxOpenRatio = 0.5f;        // Net turn over path length: gestures end near their start
+    uint8_t confirmSteps = 5;         // 100 ms without a better match before reporting
+    uint8_t refractorySteps = 30;     // 600 ms after a report
+  };
+
+  static constexpr float kStepS = 0.02f;
+  static constexpr float kSoftSpeedDps = 60.0f;
+  static constexpr size_t kWindowSteps = 64;  // 1.28 s: the slowest gesture that is recognized
+  static constexpr size_t kMaxTemplateSteps = 40;
+  static constexpr size_t kTemplateCount = 10;  // Two flicks, circles from four phases each way
+
+  GestureRecognizer() : GestureRecognizer(Config()) {}
+  explicit GestureRecognizer(const Config& config);
+
+  // Screen-oriented pointing rates in deg/s (x right, y down), dt in seconds. Returns the
+  // gesture confirmed by this sample, or Gesture::None.
+  Gesture update(float xDps, float yDps, float dt);
+  void reset();
+
+  float lastScore() const { return lastScore_; }
+  const Config& config() const { return config_; }
+
+ private:
+  struct Template {
+    Gesture gesture = Gesture::None;
+    uint8_t length = 0;
+    float minPeakDps = 0.0f;
+    float invEnergy = 0.0f;  // 1 / (length * mean squared feature magnitude)
+    float x[kMaxTemplateSteps];
+    float y[kMaxTemplateSteps];
+    float cost[kMaxTemplateSteps + 1];
+    uint32_t start[kMaxTemplateSteps + 1];
+  };
+
+  void addTemplate(Gesture gesture, float minPeakDps, const float* x, const float* y, size_t length);
+  void step(float xDps, float yDps);
+  void restartColumns();
+  bool spanLooksLikeGesture(uint32_t firstStep, uint32_t lastStep, float minPeakDps) const;
+
+  Config config_;
+  Template templates_[kTemplateCount];
+  size_t templateCount_ = 0;
+
+  // Step rates in deg/s, indexed by step % kWindowSteps.
+  float ringX_[kWindowSteps];
+  float ringY_[kWindowSteps];
+  uint32_t steps_ = 0;
+  uint32_t refractoryUntil_ = 0;
+
+  float accumX_ = 0.0f;
+  float accumY_ = 0.0f;
+  float accumT_ = 0.0f;
+
+  Gesture candidate_ = Gesture::None;
+  float candidateScore_ = 0.0f;
+  uint32_t candidateStep_ = 0;
+  float lastScore_ = 0.0f;
+};
+
+#endif  // IMUPOINTER_GESTURE_RECOGNIZER_H
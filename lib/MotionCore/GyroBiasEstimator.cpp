@@ -0,0 +1,80 @@
+#include "GyroBiasEstimator.h"
+
+#include <math.h>
+
+namespace {
+constexpr float kResetVarianceDps2 = 1.0e-3f;
+}  // namespace
+
+void GyroBiasEstimator::reset(float bx, float by, float bz) {
+  bias_[0] = bx;
+  bias_[1] = by;
+  bias_[2] = bz;
+  variance_ = kResetVarianceDps2;
+  count_ = 0;
+  windowRest_ = true;
+  for (int i = 0; i < 3; ++i) {
+    sum_[i] = 0.0f;
+    sumSq_[i] = 0.0f;
+  }
+}
+
+bool GyroBiasEstimator::addSample(float gx, float gy, float gz, bool restLocked) {
+  const float g[3] = {gx, gy, gz};
+  for (int i = 0; i < 3; ++i) {
+    // Accumulate relative to the current bias to keep the sums small and well conditioned.
+    const float d = g[i] - bias_[i];
+    sum_[i] += d;
+    sumSq_[i] += d * d;
+  }
+  windowRest_ = windowRest_ && restLocked;
+  if (++count_ < config_.windowSamples) {
+    return false;
+  }
+  return closeWindow();
+}
+
+bool GyroBiasEstimator::closeWindow() {
+  const float n = static_cast<float>(count_);
+  float mean[3];
+  float maxVar = 0.0f;
+  for (int i = 0; i < 3; ++i) {
+    mean[i] = sum_[i] / n;
+    const float var = sumSq_[i] / n - mean[i] * mean[i];
+    maxVar = (var > maxVar) ? var : maxVar;
+  }
+  const bool rest = windowRest_;
+  count_ = 0;
+  windowRest_ = true;
+  for (int i = 0; i < 3; ++i) {
+    sum_[i] = 0.0f;
+    sumSq_[i] = 0.0f;
+  }
+
+  const float maxStd2 = config_.maxWindowStdDps * config_.maxWindowStdDps;
+  if (maxVar > maxStd2) {
+    return false;  // Moving: not a bias measurement at all
+  }
+  const float outlier2 = config_.outlierDps * config_.outlierDps;
+  for (int i = 0; i < 3; ++i) {
+    if (mean[i] * mean[i] > outlier2) {
+      ++rejected_;
+      return false;
+    }
+  }
+
+  // Measurement noise of a window mean, inflated when the device is only held still.
+  float r = maxVar / n + config_.measurementFloorDps2;
+  if (!rest) {
+    r *= config_.heldNoiseScale;
+  }
+  variance_ += config_.processNoiseDps2;
+  const float k = variance_ / (variance_ + r);
+  for (int i = 0; i < 3; ++i) {
+    windowMean_[i] = bias_[i] + mean[i];
+    bias_[i] += k * mean[i];
+  }
+  variance_ *= (1.0f - k);
+  ++accepted_;
+  return true;
+}
@@ -0,0 +1,56 @@
+#ifndef IMUPOINTER_GYRO_BIAS_ESTIMATOR_H
+#define IMUPOINTER_GYRO_BIAS_ESTIMATOR_H
+
+#include <stdint.h>
+
+// Background gyro bias tracker. Raw gyro samples are grouped into short windows; a window
+// whose spread is small enough to mean "not moving" yields a bias measurement, which is
+// blended in with a scalar Kalman update. Windows whose mean sits far from the current bias
+// are rejected as slow deliberate rotation rather than drift.
+class GyroBiasEstimator {
+ public:
+  struct Config {
+    uint16_t windowSamples = 64;        // 256 ms at 250 Hz
+    float maxWindowStdDps = 0.35f;      // Spread above this means the device is moving
+    float outlierDps = 1.5f;            // |window mean - bias| above this is rejected
+    float processNoiseDps2 = 1.0e-5f;   // Drift allowance added per window
+    float measurementFloorDps2 = 2.0e-4f;
+    float heldNoiseScale = 8.0f;        // Held-still windows are trusted less than desk rest
+  };
+
+  GyroBiasEstimator() = default;
+  explicit GyroBiasEstimator(const Config& config) : config_(config) {}
+
+  // Restarts from a known bias (e.g. after a full calibration) with low uncertainty.
+  void reset(float bx, float by, float bz);
+
+  // Raw, uncorrected gyro in deg/s. Returns true when the bias estimate changed.
+  bool addSample(float gx, float gy, float gz, bool restLocked);
+
+  float biasX() const { return bias_[0]; }
+  float biasY() const { return bias_[1]; }
+  float biasZ() const { return bias_[2]; }
+  float varianceDps2() const { return variance_; }
+  // Raw mean of the most recent accepted window, i.e. the bias measured at that moment.
+  float windowMeanX() const { return windowMean_[0]; }
+  float windowMeanY() const { return windowMean_[1]; }
+  float windowMeanZ() const { return windowMean_[2]; }
+  uint32_t acceptedWindows() const { return accepted_; }
+  uint32_t rejectedWindows() const { return rejected_; }
+
+ private:
+  bool closeWindow();
+
+  Config config_;
+  float bias_[3] = {0.0f, 0.0f, 0.0f};
+  float variance_ = 1.0f;  // Estimate variance (dps^2), shared by the three axes
+  float windowMean_[3] = {0.0f, 0.0f, 0.0f};
+  float sum_[3] = {0.0f, 0.0f, 0.0f};
+  float sumSq_[3] = {0.0f, 0.0f, 0.0f};
+  uint16_t count_ = 0;
+  bool windowRest_ = true;
+  uint32_t accepted_ = 0;
+  uint32_t rejected_ = 0;
+};
+
+#endif  // IMUPOINTER_GYRO_BIAS_ESTIMATOR_H
@@ -0,0 +1,70 @@
+#include "ImuFifo.h"
+
+namespace {
+// Hamming-windowed sinc, fc = 110 Hz at fs = 1 kHz, normalized to unity DC gain.
+// Response: -2.8 dB at 100 Hz, -18 dB at 250 Hz, -45 dB at 375 Hz.
+constexpr float kDecimatorTaps[ImuDecimator::kTaps] = {
+  0.006686f, 0.044247f, 0.163046f, 0.286020f,
+  0.286020f, 0.163046f, 0.044247f, 0.006686f,
+};
+
+int16_t readBe16(const uint8_t* p) {
+  return static_cast<int16_t>((static_cast<uint16_t>(p[0]) << 8) | p[1]);
+}
+}  // namespace
+
+size_t parseMpu6886Fifo(const uint8_t* data, size_t length, ImuSample* out, size_t maxSamples) {
+  const size_t frames = length / kMpu6886FifoFrameBytes;
+  const size_t count = (frames < maxSamples) ? frames : maxSamples;
+  for (size_t i = 0; i < count; ++i) {
+    const uint8_t* f = data + i * kMpu6886FifoFrameBytes;
+    ImuSample& s = out[i];
+    s.ax = readBe16(f + 0) / kMpu6886AccelLsbPerG;
+    s.ay = readBe16(f + 2) / kMpu6886AccelLsbPerG;
+    s.az = readBe16(f + 4) / kMpu6886AccelLsbPerG;
+    s.tempC = readBe16(f + 6) / kMpu6886TempLsbPerC + kMpu6886TempOffsetC;
+    s.gx = readBe16(f + 8) / kMpu6886GyroLsbPerDps;
+    s.gy = readBe16(f + 10) / kMpu6886GyroLsbPerDps;
+    s.gz = readBe16(f + 12) / kMpu6886GyroLsbPerDps;
+  }
+  return count;
+}
+
+bool ImuDecimator::push(const ImuSample& in, ImuSample& out) {
+  history_[head_] = in;
+  head_ = (head_ + 1) % kTaps;
+  if (filled_ < kTaps) {
+    ++filled_;
+  }
+  phase_ = (phase_ + 1) % kFactor;
+  if (phase_ != 0) {
+    return false;
+  }
+
+  if (filled_ < kTaps) {
+    // Warm-up: pass the newest frame through until the window is full.
+    out = in;
+    return true;
+  }
+
+  ImuSample acc;
+  for (size_t k = 0; k < kTaps; ++k) {
+    const ImuSample& s = history_[(head_ + k) % kTaps];
+    const float h = kDecimatorTaps[k];
+    acc.gx += h * s.gx;
+    acc.gy += h * s.gy;
+    acc.gz += h * s.gz;
+    acc.ax += h * s.ax;
+    acc.ay += h * s.ay;
+    acc.az += h * s.az;
+  }
+  acc.tempC = in.tempC;
+  out = acc;
+  return true;
+}
+
+void ImuDecimator::reset() {
+  head_ = 0;
+  filled_ = 0;
+  phase_ = 0;
+}
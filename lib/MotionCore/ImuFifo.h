@@ -0,0 +1,49 @@
+#ifndef IMUPOINTER_IMU_FIFO_H
+#define IMUPOINTER_IMU_FIFO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// One IMU reading in physical units: gyro in deg/s, accel in g, die temperature in deg C.
+struct ImuSample {
+  float gx = 0.0f;
+  float gy = 0.0f;
+  float gz = 0.0f;
+  float ax = 0.0f;
+  float ay = 0.0f;
+  float az = 0.0f;
+  float tempC = 0.0f;
+};
+
+// MPU6886 FIFO layout with accel + gyro enabled: accel XYZ, temperature, gyro XYZ,
+// each a big-endian int16. Temperature is always written alongside the sensor data.
+constexpr size_t kMpu6886FifoFrameBytes = 14;
+constexpr float kMpu6886GyroLsbPerDps = 16.4f;    // +/-2000 dps full scale
+constexpr float kMpu6886AccelLsbPerG = 4096.0f;   // +/-8 g full scale
+constexpr float kMpu6886TempLsbPerC = 326.8f;
+constexpr float kMpu6886TempOffsetC = 25.0f;
+
+// Decodes whole frames from a FIFO burst. Trailing partial frames are ignored.
+// Returns the number of samples written to out.
+size_t parseMpu6886Fifo(const uint8_t* data, size_t length, ImuSample* out, size_t maxSamples);
+
+// Linear-phase FIR low-pass followed by 4:1 decimation (1 kHz -> 250 Hz).
+// Only every fourth input is convolved, so the cost is one 8-tap dot product per output.
+// Group delay is 3.5 input samples (3.5 ms at 1 kHz).
+class ImuDecimator {
+ public:
+  static constexpr size_t kFactor = 4;
+  static constexpr size_t kTaps = 8;
+
+  // Returns true when a decimated sample was written to out.
+  bool push(const ImuSample& in, ImuSample& out);
+  void reset();
+
+ private:
+  ImuSample history_[kTaps];
+  size_t head_ = 0;
+  size_t filled_ = 0;
+  size_t phase_ = 0;
+};
+
+#endif  // IMUPOINTER_IMU_FIFO_H
@@ -0,0 +1,44 @@
+#include "LatencyHistogram.h"
+
+void LatencyHistogram::record(uint32_t us) {
+  const uint32_t index = us / kBucketUs;
+  if (index < kBuckets) {
+    ++buckets_[index];
+  } else {
+    ++overflow_;
+  }
+  ++count_;
+  sum_ += us;
+  min_ = (us < min_) ? us : min_;
+  max_ = (us > max_) ? us : max_;
+}
+
+void LatencyHistogram::reset() {
+  for (size_t i = 0; i < kBuckets; ++i) {
+    buckets_[i] = 0;
+  }
+  overflow_ = 0;
+  count_ = 0;
+  min_ = UINT32_MAX;
+  max_ = 0;
+  sum_ = 0;
+}
+
+uint32_t LatencyHistogram::percentileUs(float p) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  p = (p < 0.0f) ? 0.0f : (p > 100.0f ? 100.0f : p);
+  // Rank of the requested sample, 1-based (nearest-rank method).
+  uint32_t rank = static_cast<uint32_t>(p / 100.0f * static_cast<float>(count_) + 0.999f);
+  rank = (rank == 0) ? 1 : rank;
+  uint32_t seen = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      const uint32_t upper = static_cast<uint32_t>(i + 1) * kBucketUs;
+      return (upper < max_) ? upper : max_;
+    }
+  }
+  return max_;
+}
@@ -0,0 +1,37 @@
+#ifndef IMUPOINTER_LATENCY_HISTOGRAM_H
+#define IMUPOINTER_LATENCY_HISTOGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed-bucket latency histogram: 250 us buckets covering 0..24 ms plus an overflow bucket.
+// record() is a divide and an increment, so it can run on the HID path for every report.
+// Percentiles resolve to the upper edge of the bucket that holds them.
+class LatencyHistogram {
+ public:
+  static constexpr uint32_t kBucketUs = 250;
+  static constexpr size_t kBuckets = 96;
+
+  void record(uint32_t us);
+  void reset();
+
+  uint32_t count() const { return count_; }
+  uint32_t minUs() const { return count_ ? min_ : 0; }
+  uint32_t maxUs() const { return max_; }
+  uint32_t meanUs() const { return count_ ? static_cast<uint32_t>(sum_ / count_) : 0; }
+  // p in 0..100. Samples past the last bucket report the observed maximum.
+  uint32_t percentileUs(float p) const;
+
+  uint32_t bucket(size_t index) const { return buckets_[index]; }
+  uint32_t overflow() const { return overflow_; }
+
+ private:
+  uint32_t buckets_[kBuckets] = {};
+  uint32_t overflow_ = 0;
+  uint32_t count_ = 0;
+  uint32_t min_ = UINT32_MAX;
+  uint32_t max_ = 0;
+  uint64_t sum_ = 0;
+};
+
+#endif  // IMUPOINTER_LATENCY_HISTOGRAM_H
@@ -0,0 +1,163 @@
+#include "MotionPipeline.h"
+
+#include <math.h>
+
+#include "FastMath.h"
+#include "OrientationFilter.h"
+
+namespace {
+int16_t clampToInt16(long value) {
+  return static_cast<int16_t>(value < -32767 ? -32767 : (value > 32767 ? 32767 : value));
+}
+}  // namespace
+
+float MotionPipeline::deadzone(float value, float deadzoneDps) {
+  if (fabsf(value) < deadzoneDps) {
+    return 0.0f;
+  }
+  return value;
+}
+
+void MotionPipeline::resetIntegrators() {
+  predictor_.reset();
+  filter_.reset();
+  accumX_ = 0.0f;
+  accumY_ = 0.0f;
+  accumWheel_ = 0.0f;
+}
+
+void MotionPipeline::reset() {
+  resetIntegrators();
+  restLock_ = false;
+  restCandidateMs_ = 0;
+  restLockSinceMs_ = 0;
+}
+
+bool MotionPipeline::process(const MotionInput& in, PointerDelta& out) {
+  out = PointerDelta();
+  float activeDeadzone = config_.deadzoneDps;
+  const BallisticsProfile& profile = *in.profile;
+  float sensitivityX = profile.sensitivityX;
+  float sensitivityY = profile.sensitivityY;
+
+  // Click stabilization: suppress initial shake and reduce movement while holding left-click.
+  if (in.buttons.left) {
+    if (!leftHeld_) {
+      leftHeld_ = true;
+      leftPressMs_ = in.timestampMs;
+      resetIntegrators();
+    }
+    if (in.timestampMs - leftPressMs_ < config_.clickStabilizeMs) {
+      resetIntegrators();
+      return false;
+    }
+    activeDeadzone = (config_.clickDeadzoneDps > activeDeadzone) ? config_.clickDeadzoneDps : activeDeadzone;
+    sensitivityX *= config_.clickSensitivityScale;
+    sensitivityY *= config_.clickSensitivityScale;
+  } else {
+    leftHeld_ = false;
+  }
+
+  const float gx = deadzone(in.gx, activeDeadzone);
+  const float gy = deadzone(in.gy, activeDeadzone);
+  const float gz = deadzone(in.gz, activeDeadzone);
+  if (!updateRestLock(in, gx, gy, gz)) {
+    return false;
+  }
+
+  // Pointing rates come from the fused orientation: yaw about world vertical and pitch about
+  // the horizontal axis across the stick, so the mapping holds however the stick is rolled.
+  float yawDps = 0.0f;
+  float pitchDps = 0.0f;
+  pointingRates(in.upX, in.upY, in.upZ, in.gx, in.gy, in.gz, yawDps, pitchDps);
+  yawDps = deadzone(yawDps, activeDeadzone);
+  pitchDps = deadzone(pitchDps, activeDeadzone);
+
+  if (in.buttons.scroll) {
+    predictor_.reset();
+    return quantizeWheel(pitchDps, in.dt, out);
+  }
+
+  // The filter is driven by the measured speed so a predicted lead does not also open it up.
+  const float speedDps = fastHypot(yawDps, pitchDps);
+  predictor_.setHorizonMs(profile.predictionHorizonMs);
+  predictor_.update(yawDps, pitchDps, in.dt, yawDps, pitchDps);
+
+  // X follows yaw so left/right feels like pointing; Y follows pitch.
+  const float gain = profile.gainAt(fastHypot(yawDps, pitchDps));
+  filter(-yawDps * sensitivityX * gain * in.dt, pitchDps * sensitivityY * gain * in.dt, speedDps, in.dt);
+  return quantize(out);
+}
+
+bool MotionPipeline::updateRestLock(const MotionInput& in, float gx, float gy, float gz) {
+  // Desk-rest lock: when device is still and lying flat for a short period,
+  // freeze motion so the pointer does not drift while set down.
+  const uint32_t now = in.timestampMs;
+  const float ax = in.ax;
+  const float ay = in.ay;
+  const float az = in.az;
+  const float restGyro = config_.restGyroDps;
+  const bool lowGyro = fabsf(gx) < restGyro && fabsf(gy) < restGyro && fabsf(gz) < restGyro;
+  const bool flatDesk = in.haveAccel && fabsf(az) > config_.flatAccelZMin &&
+                        fabsf(ax) < config_.flatAccelXYMax && fabsf(ay) < config_.flatAccelXYMax;
+  if (!restLock_) {
+    if (lowGyro && flatDesk) {
+      if (restCandidateMs_ == 0) {
+        restCandidateMs_ = now;
+      } else if (now - restCandidateMs_ >= config_.restEnterMs) {
+        restLock_ = true;
+        restLockSinceMs_ = now;
+        restCandidateMs_ = 0;
+        resetIntegrators();
+      }
+    } else {
+      restCandidateMs_ = 0;
+    }
+    return true;
+  }
+
+  const uint32_t lockedFor = now - restLockSinceMs_;
+  const float wakeGyro = (lockedFor >= config_.restWakeTightenMs) ? config_.restWakeGyroLateDps
+                                                                  : config_.restWakeGyroEarlyDps;
+  const bool pickedUp = in.haveAccel && (fabsf(ax) > config_.restPickupTiltG || fabsf(ay) > config_.restPickupTiltG ||
+                                         fabsf(az) < config_.restPickupZMinG);
+  const bool wakeByGyro = fabsf(gx) > wakeGyro || fabsf(gy) > wakeGyro || fabsf(gz) > wakeGyro;
+  resetIntegrators();
+  if (pickedUp || wakeByGyro) {
+    restLock_ = false;
+    restCandidateMs_ = 0;
+    restLockSinceMs_ = 0;
+    return true;
+  }
+  return false;
+}
+
+void MotionPipeline::filter(float moveX, float moveY, float speedDps, float dt) {
+  filter_.update(moveX, moveY, speedDps, dt);
+}
+
+bool MotionPipeline::quantize(PointerDelta& out) {
+  accumX_ += filter_.x();
+  accumY_ += filter_.y();
+  const long moveX = roundToLong(accumX_);
+  const long moveY = roundToLong(accumY_);
+  if (moveX == 0 && moveY == 0) {
+    return false;
+  }
+  accumX_ -= static_cast<float>(moveX);
+  accumY_ -= static_cast<float>(moveY);
+  out.x = clampToInt16(moveX);
+  out.y = clampToInt16(moveY);
+  return true;
+}
+
+bool MotionPipeline::quantizeWheel(float pitchDps, float dt, PointerDelta& out) {
+  accumWheel_ += pitchDps * config_.scrollSensitivity * config_.wheelResolution * dt;
+  const long wheel = roundToLong(accumWheel_);
+  if (wheel == 0) {
+    return false;
+  }
+  accumWheel_ -= static_cast<float>(wheel);
+  out.wheel = clampToInt16(wheel);
+  return true;
+}
@@ -0,0 +1,107 @@
+#ifndef IMUPOINTER_MOTION_PIPELINE_H
+#define IMUPOINTER_MOTION_PIPELINE_H
+
+#include <stdint.h>
+
+#include "BallisticsProfile.h"
+#include "MotionPredictor.h"
+#include "OneEuroFilter.h"
+
+// Button state sampled alongside each motion sample.
+struct PointerButtons {
+  bool left = false;    // Left button held: click stabilization applies
+  bool scroll = false;  // Scroll modifier held: pitch drives the wheel instead of X/Y
+};
+
+// One motion-rate sample. Rates are bias-corrected body rates; up is the body-frame
+// world-up direction from the orientation filter.
+struct MotionInput {
+  uint32_t timestampMs = 0;
+  float dt = 0.0f;  // Seconds since the previous sample
+  float gx = 0.0f;
+  float gy = 0.0f;
+  float gz = 0.0f;
+  float ax = 0.0f;
+  float ay = 0.0f;
+  float az = 0.0f;
+  bool haveAccel = false;
+  float upX = 0.0f;
+  float upY = 0.0f;
+  float upZ = 1.0f;
+  PointerButtons buttons;
+  const BallisticsProfile* profile = &kBallisticsProfiles[0];  // Sensitivity and gain curve
+};
+
+// HID counts to send. Wheel is in 1/wheelResolution detents.
+struct PointerDelta {
+  int16_t x = 0;
+  int16_t y = 0;
+  int16_t wheel = 0;
+};
+
+// Gyro-to-pointer math: deadzone, desk-rest lock, roll-invariant pointing rates, optional
+// latency prediction, ballistics (sensitivity and gain curve from the sample's profile), speed-adaptive low-pass filter and sub-count
+// quantization. No hardware access and no allocation;
+// the firmware feeds it from the motion task and the native bench drives it with traces.
+class MotionPipeline {
+ public:
+  struct Config {
+    float scrollSensitivity = 0.85f;    // Detents per degree of pitch
+    uint8_t wheelResolution = 8;        // Wheel units per detent
+    float deadzoneDps = 1.20f;
+    MotionPredictor::Config predictor;  // Pointing-rate extrapolation; the profile sets horizonMs
+    OneEuroFilter::Config filter;       // Adaptive smoothing of the per-sample X/Y counts
+    float restGyroDps = 3.20f;          // Near-still threshold for desk-rest lock
+    uint32_t restEnterMs = 360;
+    float flatAccelZMin = 0.90f;
+    float flatAccelXYMax = 0.30f;
+    uint32_t restWakeTightenMs = 2200;
+    float restWakeGyroEarlyDps = 2.7f;
+    float restWakeGyroLateDps = 8.8f;
+    float restPickupTiltG = 0.42f;
+    float restPickupZMinG = 0.75f;
+    uint32_t clickStabilizeMs = 140;    // Freeze movement right after a left press
+    float clickSensitivityScale = 0.30f;
+    float clickDeadzoneDps = 2.80f;
+  };
+
+  MotionPipeline() = default;
+  explicit MotionPipeline(const Config& config)
+      : config_(config), predictor_(config.predictor), filter_(config.filter) {}
+
+  // Runs one sample through every stage. Returns true when out holds a non-zero delta.
+  bool process(const MotionInput& in, PointerDelta& out);
+
+  // Clears the sub-count integrators and filter state (rest lock is kept).
+  void resetIntegrators();
+  // Full reset, including the rest lock; used when tracking is paused.
+  void reset();
+
+  bool restLocked() const { return restLock_; }
+  const Config& config() const { return config_; }
+
+  // Individual stages, public so the native bench can time them in isolation.
+  static float deadzone(float value, float deadzoneDps);
+  // Updates the desk-rest lock from deadzoned rates; returns false while motion is suppressed.
+  bool updateRestLock(const MotionInput& in, float gx, float gy, float gz);
+  // moveX/moveY are this sample's counts; speedDps is the pointing speed behind them.
+  void filter(float moveX, float moveY, float speedDps, float dt);
+  bool quantize(PointerDelta& out);
+
+ private:
+  bool quantizeWheel(float pitchDps, float dt, PointerDelta& out);
+
+  Config config_;
+  MotionPredictor predictor_;
+  OneEuroFilter filter_;
+  float accumX_ = 0.0f;
+  float accumY_ = 0.0f;
+  float accumWheel_ = 0.0f;
+  bool restLock_ = false;
+  uint32_t restCandidateMs_ = 0;
+  uint32_t restLockSinceMs_ = 0;
+  bool leftHeld_ = false;
+  uint32_t leftPressMs_ = 0;
+};
+
+#endif  // IMUPOINTER_MOTION_PIPELINE_H
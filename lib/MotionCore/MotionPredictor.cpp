@@ -0,0 +1,43 @@
+#include "MotionPredictor.h"
+
+float MotionPredictor::track(Axis& axis, float measured, float dt) const {
+  const float predicted = axis.rate + axis.accel * dt;
+  const float residual = measured - predicted;
+  axis.rate = predicted + config_.alpha * residual;
+  axis.accel += config_.beta * residual / dt;
+
+  if (measured == 0.0f) {
+    return 0.0f;  // Inside the deadzone: stopping must stop, not coast
+  }
+  float lead = axis.accel * config_.horizonMs * 0.001f;
+  lead = (lead > config_.maxLeadDps) ? config_.maxLeadDps : lead;
+  lead = (lead < -config_.maxLeadDps) ? -config_.maxLeadDps : lead;
+  const float out = measured + lead;
+  if ((out > 0.0f) != (measured > 0.0f)) {
+    return 0.0f;  // Reversal ahead: hold at zero instead of swinging past it
+  }
+  return out;
+}
+
+void MotionPredictor::update(float yawDps, float pitchDps, float dt, float& predictedYawDps,
+                             float& predictedPitchDps) {
+  if (!enabled() || dt <= 0.0f) {
+    predictedYawDps = yawDps;
+    predictedPitchDps = pitchDps;
+    return;
+  }
+  predictedYawDps = track(yaw_, yawDps, dt);
+  predictedPitchDps = track(pitch_, pitchDps, dt);
+}
+
+void MotionPredictor::reset() {
+  yaw_ = Axis();
+  pitch_ = Axis();
+}
+
+void MotionPredictor::setHorizonMs(float horizonMs) {
+  if (horizonMs != config_.horizonMs) {
+    config_.horizonMs = horizonMs;
+    reset();
+  }
+}
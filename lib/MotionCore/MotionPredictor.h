@@ -0,0 +1,42 @@
+#ifndef IMUPOINTER_MOTION_PREDICTOR_H
+#define IMUPOINTER_MOTION_PREDICTOR_H
+
+// Short-horizon extrapolation of the yaw/pitch pointing rates to hide filter and link delay.
+// Each axis runs an alpha-beta tracker of rate and angular acceleration; the output is the
+// measured rate plus acceleration * horizon. The lead is capped, and a prediction is never
+// allowed to cross zero, so decelerating into a direction reversal or a stop cannot overshoot.
+class MotionPredictor {
+ public:
+  struct Config {
+    float horizonMs = 0.0f;     // Lead time; 0 passes the rates through unchanged
+    float alpha = 0.40f;        // Rate correction gain
+    float beta = 0.04f;         // Acceleration correction gain
+    float maxLeadDps = 60.0f;   // Largest difference allowed between prediction and measurement
+  };
+
+  MotionPredictor() = default;
+  explicit MotionPredictor(const Config& config) : config_(config) {}
+
+  // Rates in deg/s, dt in seconds. Writes the rates predicted horizonMs ahead.
+  void update(float yawDps, float pitchDps, float dt, float& predictedYawDps, float& predictedPitchDps);
+  void reset();
+  // Switching horizon restarts the tracker, so no acceleration from before is carried over.
+  void setHorizonMs(float horizonMs);
+
+  bool enabled() const { return config_.horizonMs > 0.0f; }
+  const Config& config() const { return config_; }
+
+ private:
+  struct Axis {
+    float rate = 0.0f;
+    float accel = 0.0f;  // deg/s^2
+  };
+
+  float track(Axis& axis, float measured, float dt) const;
+
+  Config config_;
+  Axis yaw_;
+  Axis pitch_;
+};
+
+#endif  // IMUPOINTER_MOTION_PREDICTOR_H
@@ -0,0 +1,30 @@
+#include "OneEuroFilter.h"
+
+namespace {
+constexpr float kTwoPi = 6.2831853f;
+}  // namespace
+
+float OneEuroFilter::alpha(float cutoffHz, float dt) {
+  const float r = kTwoPi * cutoffHz * dt;
+  return r / (r + 1.0f);
+}
+
+void OneEuroFilter::update(float x, float y, float speedDps, float dt) {
+  if (dt <= 0.0f) {
+    return;
+  }
+  speed_ += alpha(config_.speedCutoffHz, dt) * (speedDps - speed_);
+  float cutoff = config_.minCutoffHz + config_.betaHzPerDps * speed_;
+  cutoff = (cutoff > config_.maxCutoffHz) ? config_.maxCutoffHz : cutoff;
+  cutoffHz_ = cutoff;
+  const float a = alpha(cutoff, dt);
+  x_ += a * (x - x_);
+  y_ += a * (y - y_);
+}
+
+void OneEuroFilter::reset() {
+  x_ = 0.0f;
+  y_ = 0.0f;
+  speed_ = 0.0f;
+  cutoffHz_ = 0.0f;
+}
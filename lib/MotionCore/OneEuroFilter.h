@@ -0,0 +1,41 @@
+#ifndef IMUPOINTER_ONE_EURO_FILTER_H
+#define IMUPOINTER_ONE_EURO_FILTER_H
+
+// Speed-adaptive low-pass for the two pointer axes (the One-Euro filter of Casiez et al.).
+// The cutoff sits at minCutoffHz while the stick is held still and rises by betaHzPerDps with
+// the smoothed angular speed, so fine aiming stays steady and sweeps keep little lag.
+// Both axes share one cutoff driven by the speed magnitude, so diagonal moves are not skewed.
+// The smoothing factor is derived from dt, so the response is the same at any sample rate.
+class OneEuroFilter {
+ public:
+  struct Config {
+    float minCutoffHz = 3.0f;      // Cutoff while still; the old fixed EMA was ~5.4 Hz at 250 Hz
+    float betaHzPerDps = 0.20f;    // Cutoff increase per deg/s of angular speed
+    float maxCutoffHz = 40.0f;
+    float speedCutoffHz = 10.0f;   // Low-pass on the speed that drives the cutoff
+  };
+
+  OneEuroFilter() = default;
+  explicit OneEuroFilter(const Config& config) : config_(config) {}
+
+  // Filters one sample. speedDps is the angular speed behind (x, y); dt in seconds.
+  void update(float x, float y, float speedDps, float dt);
+  void reset();
+
+  float x() const { return x_; }
+  float y() const { return y_; }
+  float cutoffHz() const { return cutoffHz_; }
+  const Config& config() const { return config_; }
+
+  // First-order low-pass blend factor for a cutoff frequency and step.
+  static float alpha(float cutoffHz, float dt);
+
+ private:
+  Config config_;
+  float x_ = 0.0f;
+  float y_ = 0.0f;
+  float speed_ = 0.0f;
+  float cutoffHz_ = 0.0f;
+};
+
+#endif  // IMUPOINTER_ONE_EURO_FILTER_H
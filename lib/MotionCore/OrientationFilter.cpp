@@ -0,0 +1,114 @@
+#include "OrientationFilter.h"
+
+#include <math.h>
+
+#include "FastMath.h"
+
+namespace {
+constexpr float kDegToRad = 0.01745329252f;
+constexpr float kAccelGateMinG2 = 0.85f * 0.85f;
+constexpr float kAccelGateMaxG2 = 1.15f * 1.15f;
+constexpr float kMinHorizontalNorm = 0.2f;  // Below this the pointing axis is near vertical
+}  // namespace
+
+void OrientationFilter::reset() {
+  initialized_ = false;
+  q0_ = 1.0f;
+  q1_ = q2_ = q3_ = 0.0f;
+  integralX_ = integralY_ = integralZ_ = 0.0f;
+}
+
+// Level quaternion (zero yaw) whose up vector matches the measured gravity.
+void OrientationFilter::initFromAccel(float ax, float ay, float az) {
+  const float roll = atan2f(ay, az);
+  const float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+  const float cr = cosf(roll * 0.5f);
+  const float sr = sinf(roll * 0.5f);
+  const float cp = cosf(pitch * 0.5f);
+  const float sp = sinf(pitch * 0.5f);
+  q0_ = cr * cp;
+  q1_ = sr * cp;
+  q2_ = cr * sp;
+  q3_ = -sr * sp;
+  integralX_ = integralY_ = integralZ_ = 0.0f;
+  initialized_ = true;
+}
+
+void OrientationFilter::update(const ImuSample& sample, float dt) {
+  float gx = sample.gx * kDegToRad;
+  float gy = sample.gy * kDegToRad;
+  float gz = sample.gz * kDegToRad;
+  float ax = sample.ax;
+  float ay = sample.ay;
+  float az = sample.az;
+
+  const float accelNorm2 = ax * ax + ay * ay + az * az;
+  if (!initialized_) {
+    if (accelNorm2 <= 0.0f) {
+      return;
+    }
+    initFromAccel(ax, ay, az);
+    return;
+  }
+
+  if (accelNorm2 > kAccelGateMinG2 && accelNorm2 < kAccelGateMaxG2) {
+    const float invNorm = 1.0f / sqrtf(accelNorm2);
+    ax *= invNorm;
+    ay *= invNorm;
+    az *= invNorm;
+
+    float vx = 0.0f;
+    float vy = 0.0f;
+    float vz = 0.0f;
+    upVector(vx, vy, vz);
+
+    // Error is the rotation that would take the estimated up vector onto the measured one.
+    const float ex = ay * vz - az * vy;
+    const float ey = az * vx - ax * vz;
+    const float ez = ax * vy - ay * vx;
+
+    integralX_ += gains_.ki * ex * dt;
+    integralY_ += gains_.ki * ey * dt;
+    integralZ_ += gains_.ki * ez * dt;
+    gx += gains_.kp * ex + integralX_;
+    gy += gains_.kp * ey + integralY_;
+    gz += gains_.kp * ez + integralZ_;
+  }
+
+  const float halfDt = 0.5f * dt;
+  const float q0 = q0_;
+  const float q1 = q1_;
+  const float q2 = q2_;
+  const float q3 = q3_;
+  q0_ += (-q1 * gx - q2 * gy - q3 * gz) * halfDt;
+  q1_ += (q0 * gx + q2 * gz - q3 * gy) * halfDt;
+  q2_ += (q0 * gy - q1 * gz + q3 * gx) * halfDt;
+  q3_ += (q0 * gz + q1 * gy - q2 * gx) * halfDt;
+
+  const float invQNorm = 1.0f / sqrtf(q0_ * q0_ + q1_ * q1_ + q2_ * q2_ + q3_ * q3_);
+  q0_ *= invQNorm;
+  q1_ *= invQNorm;
+  q2_ *= invQNorm;
+  q3_ *= invQNorm;
+}
+
+void OrientationFilter::upVector(float& x, float& y, float& z) const {
+  x = 2.0f * (q1_ * q3_ - q0_ * q2_);
+  y = 2.0f * (q0_ * q1_ + q2_ * q3_);
+  z = q0_ * q0_ - q1_ * q1_ - q2_ * q2_ + q3_ * q3_;
+}
+
+void pointingRates(float upX, float upY, float upZ,
+                   float gx, float gy, float gz,
+                   float& yawDps, float& pitchDps) {
+  yawDps = gx * upX + gy * upY + gz * upZ;
+
+  // Lateral axis = pointing (+Y) x up = (upZ, 0, -upX), normalized.
+  const float horizontalSq = upX * upX + upZ * upZ;
+  if (horizontalSq < kMinHorizontalNorm * kMinHorizontalNorm) {
+    // Pointing straight up/down: pitch is ill-defined, keep the body-axis mapping.
+    pitchDps = gx;
+    return;
+  }
+  pitchDps = (gx * upZ - gz * upX) * fastRsqrt(horizontalSq);
+}
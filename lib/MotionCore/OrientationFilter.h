@@ -0,0 +1,55 @@
+#ifndef IMUPOINTER_ORIENTATION_FILTER_H
+#define IMUPOINTER_ORIENTATION_FILTER_H
+
+#include "ImuFifo.h"
+
+// Mahony complementary filter keeping a body-to-earth orientation quaternion.
+// Gyro drives the attitude; the accelerometer pulls it back toward gravity only while
+// |a| is close to 1 g, so hand acceleration does not tilt the estimate.
+class OrientationFilter {
+ public:
+  struct Gains {
+    float kp = 1.5f;   // Proportional pull toward measured gravity
+    float ki = 0.02f;  // Integral term (absorbs residual gyro bias)
+  };
+
+  OrientationFilter() = default;
+  explicit OrientationFilter(const Gains& gains) : gains_(gains) {}
+
+  // Gyro in deg/s (bias already removed), accel in g.
+  void update(const ImuSample& sample, float dt);
+  void reset();
+
+  bool initialized() const { return initialized_; }
+
+  // Unit "up" direction (opposite to gravity) expressed in the body frame.
+  void upVector(float& x, float& y, float& z) const;
+
+  float q0() const { return q0_; }
+  float q1() const { return q1_; }
+  float q2() const { return q2_; }
+  float q3() const { return q3_; }
+
+ private:
+  void initFromAccel(float ax, float ay, float az);
+
+  Gains gains_;
+  bool initialized_ = false;
+  float q0_ = 1.0f;
+  float q1_ = 0.0f;
+  float q2_ = 0.0f;
+  float q3_ = 0.0f;
+  float integralX_ = 0.0f;
+  float integralY_ = 0.0f;
+  float integralZ_ = 0.0f;
+};
+
+// Splits body angular rate into pointing rates that do not depend on how the stick is rolled
+// in the hand. The pointing axis is body +Y. yawDps is the rotation about world vertical and
+// pitchDps the rotation about the horizontal axis across the pointing direction.
+// Held flat and face-up this reduces to yaw = gz, pitch = gx.
+void pointingRates(float upX, float upY, float upZ,
+                   float gx, float gy, float gz,
+                   float& yawDps, float& pitchDps);
+
+#endif  // IMUPOINTER_ORIENTATION_FILTER_H
@@ -0,0 +1,40 @@
+#include "TelemetryFrame.h"
+
+uint8_t telemetryCrc8(const uint8_t* data, size_t length) {
+  // CRC-8/ATM (poly 0x07, init 0): small and table-free; records are at most 32 bytes.
+  uint8_t crc = 0;
+  for (size_t i = 0; i < length; ++i) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+
+size_t encodeTelemetryFrame(const void* record, size_t length, uint8_t* out, size_t capacity) {
+  if (length == 0 || length > kTelemetryMaxRecordBytes || capacity < length + 3) {
+    return 0;
+  }
+  const uint8_t* in = static_cast<const uint8_t*>(record);
+  const uint8_t crc = telemetryCrc8(in, length);
+
+  // COBS: each block starts with the distance to the next zero (or to the end of the block).
+  size_t codeIndex = 0;
+  size_t write = 1;
+  uint8_t code = 1;
+  for (size_t i = 0; i <= length; ++i) {
+    const uint8_t byte = (i < length) ? in[i] : crc;
+    if (byte == 0) {
+      out[codeIndex] = code;
+      codeIndex = write++;
+      code = 1;
+    } else {
+      out[write++] = byte;
+      ++code;
+    }
+  }
+  out[codeIndex] = code;
+  out[write++] = 0x00;
+  return write;
+}
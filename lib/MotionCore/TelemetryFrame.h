@@ -0,0 +1,99 @@
+#ifndef IMUPOINTER_TELEMETRY_FRAME_H
+#define IMUPOINTER_TELEMETRY_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary telemetry records. Every record is a fixed, packed little-endian struct starting with
+// TelemetryHeader. On the wire a record is followed by a CRC-8 and COBS-encoded, and frames are
+// separated by a single 0x00 byte, so a decoder can resync after any garbage (including text
+// log lines on the same port). scripts/telemetry_decode.py mirrors these layouts.
+
+enum class TelemetryRecordType : uint8_t {
+  ImuSample = 1,     // One raw 1 kHz FIFO frame
+  PointerDelta = 2,  // One MotionPipeline output
+  HidReport = 3,     // One report handed to notify()
+  StateEvent = 4,    // Mode / connection / calibration transitions
+};
+
+enum class TelemetryEvent : uint8_t {
+  Boot = 1,
+  Connected = 2,
+  Disconnected = 3,
+  ModeChanged = 4,        // value: 0 = air mouse, 1 = menu
+  TrackingChanged = 5,    // value: 0/1
+  BtnBModeChanged = 6,    // value: 0 = scroll, 1 = right click
+  CalibrationStart = 7,
+  CalibrationDone = 8,    // value: good samples
+  PairingRequested = 9,   // value: startPairingMode() result
+  RestLockChanged = 10,   // value: 0/1
+  PowerStateChanged = 11, // value: 0 = active, 1 = idle
+  GestureRecognized = 12, // value: Gesture (1 = flick left, 2 = flick right, 3 = circle)
+};
+
+#pragma pack(push, 1)
+struct TelemetryHeader {
+  uint8_t type;
+  uint8_t seq;      // Per-type counter; gaps mean dropped records
+  uint32_t timeUs;  // micros() on the device
+};
+
+struct TelemetryImuRecord {
+  static constexpr TelemetryRecordType kType = TelemetryRecordType::ImuSample;
+  TelemetryHeader header;
+  int16_t gyro[3];   // deg/s * kTelemetryGyroScale
+  int16_t accel[3];  // g * kTelemetryAccelScale
+  int16_t tempCentiC;
+};
+
+struct TelemetryDeltaRecord {
+  static constexpr TelemetryRecordType kType = TelemetryRecordType::PointerDelta;
+  TelemetryHeader header;
+  int16_t x;
+  int16_t y;
+  int16_t wheel;  // 1/8 detents
+  uint8_t flags;  // kTelemetryFlag*
+};
+
+struct TelemetryReportRecord {
+  static constexpr TelemetryRecordType kType = TelemetryRecordType::HidReport;
+  TelemetryHeader header;
+  uint8_t buttons;
+  int16_t x;
+  int16_t y;
+  int16_t wheel;
+  int16_t hWheel;
+  uint8_t delivered;
+};
+
+struct TelemetryStateRecord {
+  static constexpr TelemetryRecordType kType = TelemetryRecordType::StateEvent;
+  TelemetryHeader header;
+  uint8_t event;
+  int32_t value;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(TelemetryHeader) == 6, "telemetry header layout");
+static_assert(sizeof(TelemetryImuRecord) == 20, "telemetry IMU record layout");
+static_assert(sizeof(TelemetryDeltaRecord) == 13, "telemetry delta record layout");
+static_assert(sizeof(TelemetryReportRecord) == 16, "telemetry report record layout");
+static_assert(sizeof(TelemetryStateRecord) == 11, "telemetry state record layout");
+
+constexpr float kTelemetryGyroScale = 16.4f;   // MPU6886 LSB per deg/s at +/-2000 dps
+constexpr float kTelemetryAccelScale = 4096.0f;
+constexpr uint8_t kTelemetryFlagRestLock = 0x01;
+constexpr uint8_t kTelemetryFlagLeft = 0x02;
+constexpr uint8_t kTelemetryFlagScroll = 0x04;
+
+constexpr size_t kTelemetryMaxRecordBytes = 32;
+// COBS adds one byte per 254 plus the leading code byte; +1 CRC, +1 delimiter.
+constexpr size_t kTelemetryMaxFrameBytes = kTelemetryMaxRecordBytes + 4;
+
+uint8_t telemetryCrc8(const uint8_t* data, size_t length);
+
+// Appends the CRC, COBS-encodes and terminates with 0x00. Returns the frame length, or 0 if
+// the record is larger than kTelemetryMaxRecordBytes or out is too small.
+size_t encodeTelemetryFrame(const void* record, size_t length, uint8_t* out, size_t capacity);
+
+#endif  // IMUPOINTER_TELEMETRY_FRAME_H
@@ -0,0 +1,168 @@
+#include "TempBiasModel.h"
+
+#include <math.h>
+
+namespace {
+constexpr float kMaxBinWeight = 64.0f;
+}  // namespace
+
+TempBiasModel::TempBiasModel() {
+  clear();
+}
+
+void TempBiasModel::clear() {
+  for (size_t i = 0; i < kBins; ++i) {
+    weight_[i] = 0.0f;
+    for (size_t a = 0; a < 3; ++a) {
+      bias_[i][a] = 0.0f;
+      table_[i][a] = 0.0f;
+    }
+  }
+  for (size_t a = 0; a < 3; ++a) {
+    slope_[a] = 0.0f;
+  }
+  learnedBins_ = 0;
+  revision_ = 0;
+}
+
+void TempBiasModel::observe(float tempC, float bx, float by, float bz, float weight) {
+  if (!isfinite(tempC) || !(weight > 0.0f)) {
+    return;
+  }
+  int bin = static_cast<int>(floorf((tempC - kMinTempC) / kBinWidthC));
+  bin = (bin < 0) ? 0 : (bin >= static_cast<int>(kBins) ? static_cast<int>(kBins) - 1 : bin);
+
+  float& w = weight_[bin];
+  const float newWeight = (w + weight > kMaxBinWeight) ? kMaxBinWeight : w + weight;
+  const float k = weight / newWeight;
+  const float sample[3] = {bx, by, bz};
+  for (size_t a = 0; a < 3; ++a) {
+    bias_[bin][a] += k * (sample[a] - bias_[bin][a]);
+  }
+  w = newWeight;
+  ++revision_;
+  rebuild();
+}
+
+void TempBiasModel::predict(float tempC, float& bx, float& by, float& bz) const {
+  // Table entries sit at bin centres.
+  float pos = (tempC - kMinTempC) / kBinWidthC - 0.5f;
+  const float maxPos = static_cast<float>(kBins - 1);
+  pos = (pos < 0.0f) ? 0.0f : (pos > maxPos ? maxPos : pos);
+  size_t i = static_cast<size_t>(pos);
+  if (i >= kBins - 1) {
+    i = kBins - 2;
+  }
+  const float t = pos - static_cast<float>(i);
+  const float* lo = table_[i];
+  const float* hi = table_[i + 1];
+  bx = lo[0] + t * (hi[0] - lo[0]);
+  by = lo[1] + t * (hi[1] - lo[1]);
+  bz = lo[2] + t * (hi[2] - lo[2]);
+}
+
+void TempBiasModel::rebuild() {
+  size_t first = kBins;
+  size_t last = 0;
+  learnedBins_ = 0;
+  for (size_t i = 0; i < kBins; ++i) {
+    if (weight_[i] > 0.0f) {
+      first = (first == kBins) ? i : first;
+      last = i;
+      ++learnedBins_;
+    }
+  }
+  if (learnedBins_ == 0) {
+    return;
+  }
+
+  // Weighted least-squares slope over the learned bins, used beyond the learned range.
+  float sw = 0.0f;
+  float sx = 0.0f;
+  float sxx = 0.0f;
+  float sy[3] = {0.0f, 0.0f, 0.0f};
+  float sxy[3] = {0.0f, 0.0f, 0.0f};
+  for (size_t i = first; i <= last; ++i) {
+    const float w = weight_[i];
+    if (w <= 0.0f) {
+      continue;
+    }
+    const float x = static_cast<float>(i) * kBinWidthC;
+    sw += w;
+    sx += w * x;
+    sxx += w * x * x;
+    for (size_t a = 0; a < 3; ++a) {
+      sy[a] += w * bias_[i][a];
+      sxy[a] += w * x * bias_[i][a];
+    }
+  }
+  const float denom = sw * sxx - sx * sx;
+  for (size_t a = 0; a < 3; ++a) {
+    float s = (learnedBins_ >= 2 && denom > 1.0e-6f) ? (sw * sxy[a] - sx * sy[a]) / denom : 0.0f;
+    s = (s > kMaxSlopeDpsPerC) ? kMaxSlopeDpsPerC : (s < -kMaxSlopeDpsPerC ? -kMaxSlopeDpsPerC : s);
+    slope_[a] = s;
+  }
+
+  size_t prev = first;
+  for (size_t i = 0; i < kBins; ++i) {
+    for (size_t a = 0; a < 3; ++a) {
+      if (i < first) {
+        table_[i][a] = bias_[first][a] - slope_[a] * static_cast<float>(first - i) * kBinWidthC;
+      } else if (i > last) {
+        table_[i][a] = bias_[last][a] + slope_[a] * static_cast<float>(i - last) * kBinWidthC;
+      } else if (weight_[i] > 0.0f) {
+        table_[i][a] = bias_[i][a];
+      }
+    }
+    if (i < first || i > last) {
+      continue;
+    }
+    if (weight_[i] > 0.0f) {
+      // Fill the gap since the previous learned bin by straight-line interpolation.
+      for (size_t j = prev + 1; j < i; ++j) {
+        const float t = static_cast<float>(j - prev) / static_cast<float>(i - prev);
+        for (size_t a = 0; a < 3; ++a) {
+          table_[j][a] = bias_[prev][a] + t * (bias_[i][a] - bias_[prev][a]);
+        }
+      }
+      prev = i;
+    }
+  }
+}
+
+TempBiasModel::State TempBiasModel::state() const {
+  State out = {};
+  out.version = kStateVersion;
+  for (size_t i = 0; i < kBins; ++i) {
+    out.weight[i] = weight_[i];
+    for (size_t a = 0; a < 3; ++a) {
+      out.bias[i][a] = bias_[i][a];
+    }
+  }
+  return out;
+}
+
+bool TempBiasModel::restore(const State& state) {
+  if (state.version != kStateVersion) {
+    return false;
+  }
+  for (size_t i = 0; i < kBins; ++i) {
+    const float w = state.weight[i];
+    if (!isfinite(w) || w < 0.0f || w > kMaxBinWeight) {
+      return false;
+    }
+    for (size_t a = 0; a < 3; ++a) {
+      if (!isfinite(state.bias[i][a])) {
+        return false;
+      }
+    }
+  }
+  for (size_t i = 0; i < kBins; ++i) {
+    weight_[i] = state.weight[i];
+    for (size_t a = 0; a < 3; ++a) {
+      bias_[i][a] = state.bias[i][a];
+    }
+  }
+  rebuild();
+  return true;
+}
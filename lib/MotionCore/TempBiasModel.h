@@ -0,0 +1,56 @@
+#ifndef IMUPOINTER_TEMP_BIAS_MODEL_H
+#define IMUPOINTER_TEMP_BIAS_MODEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Gyro bias as a function of IMU die temperature. Still-period bias measurements are binned
+// by temperature (3 C bins, 10..58 C) and averaged per bin; empty bins are filled by linear
+// interpolation between learned bins and a fitted slope outside them. The filled table is
+// rebuilt only when a measurement arrives, so predict() is a clamp and one lerp per axis.
+class TempBiasModel {
+ public:
+  static constexpr size_t kBins = 16;
+  static constexpr float kMinTempC = 10.0f;
+  static constexpr float kBinWidthC = 3.0f;
+  static constexpr uint16_t kStateVersion = 1;
+  static constexpr float kMaxSlopeDpsPerC = 0.25f;  // MPU6886 datasheet: +/-0.24 dps/C worst case
+
+  // Persisted form; restore() rejects anything with a different version.
+  struct State {
+    uint16_t version;
+    uint16_t reserved;
+    float weight[kBins];
+    float bias[kBins][3];
+  };
+
+  TempBiasModel();
+
+  // Adds one bias measurement (deg/s) taken at tempC. Weight 1 is one background still window;
+  // a full calibration counts as several. Per-bin weight is capped so old data slowly ages out.
+  void observe(float tempC, float bx, float by, float bz, float weight = 1.0f);
+
+  // Bias predicted for tempC. Only meaningful once ready().
+  void predict(float tempC, float& bx, float& by, float& bz) const;
+
+  bool ready() const { return learnedBins_ > 0; }
+  size_t learnedBins() const { return learnedBins_; }
+  float slopeDpsPerC(size_t axis) const { return slope_[axis]; }
+  uint32_t revision() const { return revision_; }
+
+  void clear();
+  State state() const;
+  bool restore(const State& state);
+
+ private:
+  void rebuild();
+
+  float weight_[kBins];
+  float bias_[kBins][3];
+  float table_[kBins][3];
+  float slope_[3];
+  size_t learnedBins_;
+  uint32_t revision_;
+};
+
+#endif  // IMUPOINTER_TEMP_BIAS_MODEL_H
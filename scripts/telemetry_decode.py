@@ -0,0 +1,198 @@
+#!/usr/bin/env python3
+"""Decode IMUPointer binary telemetry into CSV files.
+
+Record layouts mirror lib/MotionCore/TelemetryFrame.h. Frames are COBS-encoded, end with a
+0x00 byte and carry a trailing CRC-8, so text log lines on the same port are skipped.
+
+Usage:
+  telemetry_decode.py capture.bin -o out_dir
+  telemetry_decode.py --port /dev/ttyUSB0 --seconds 30 -o out_dir   (needs pyserial)
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import time
+from pathlib import Path
+
+GYRO_SCALE = 16.4
+ACCEL_SCALE = 4096.0
+HEADER = struct.Struct("<BBI")
+
+EVENTS = {
+    1: "boot",
+    2: "connected",
+    3: "disconnected",
+    4: "mode",
+    5: "tracking",
+    6: "btnb_mode",
+    7: "calibration_start",
+    8: "calibration_done",
+    9: "pairing",
+    10: "rest_lock",
+    11: "power_state",
+    12: "gesture",
+}
+
+
+def decode_imu(t_us, body):
+    gx, gy, gz, ax, ay, az, temp = struct.unpack("<7h", body)
+    return [t_us, gx / GYRO_SCALE, gy / GYRO_SCALE, gz / GYRO_SCALE,
+            ax / ACCEL_SCALE, ay / ACCEL_SCALE, az / ACCEL_SCALE, temp / 100.0]
+
+
+def decode_delta(t_us, body):
+    x, y, wheel, flags = struct.unpack("<3hB", body)
+    return [t_us, x, y, wheel, flags & 1, (flags >> 1) & 1, (flags >> 2) & 1]
+
+
+def decode_report(t_us, body):
+    buttons, x, y, wheel, hwheel, delivered = struct.unpack("<B4hB", body)
+    return [t_us, buttons, x, y, wheel, hwheel, delivered]
+
+
+def decode_state(t_us, body):
+    event, value = struct.unpack("<Bi", body)
+    return [t_us, EVENTS.get(event, str(event)), value]
+
+
+# type -> (csv name, body size, decoder, columns)
+RECORDS = {
+    1: ("imu", 14, decode_imu, ["t_us", "gx_dps", "gy_dps", "gz_dps", "ax_g", "ay_g", "az_g", "temp_c"]),
+    2: ("delta", 7, decode_delta, ["t_us", "x", "y", "wheel", "rest_lock", "left", "scroll"]),
+    3: ("report", 10, decode_report, ["t_us", "buttons", "x", "y", "wheel", "hwheel", "delivered"]),
+    4: ("state", 5, decode_state, ["t_us", "event", "value"]),
+}
+
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+class Decoder:
+    def __init__(self, out_dir):
+        out_dir.mkdir(parents=True, exist_ok=True)
+        self.files = {}
+        self.writers = {}
+        for type_id, (name, _, _, columns) in RECORDS.items():
+            f = open(out_dir / f"{name}.csv", "w", newline="")
+            writer = csv.writer(f)
+            writer.writerow(columns)
+            self.files[type_id] = f
+            self.writers[type_id] = writer
+        self.counts = {type_id: 0 for type_id in RECORDS}
+        self.gaps = {type_id: 0 for type_id in RECORDS}
+        self.last_seq = {}
+        self.bad_frames = 0
+        self.pending = bytearray()
+
+    def feed(self, data):
+        self.pending += data
+        while True:
+            end = self.pending.find(b"\x00")
+            if end < 0:
+                return
+            frame = bytes(self.pending[:end])
+            del self.pending[:end + 1]
+            if frame:
+                self.handle(frame)
+
+    def handle(self, frame):
+        payload = cobs_decode(frame)
+        if payload is None or len(payload) < HEADER.size + 1 or crc8(payload[:-1]) != payload[-1]:
+            self.bad_frames += 1
+            return
+        record = payload[:-1]
+        type_id, seq, t_us = HEADER.unpack_from(record)
+        spec = RECORDS.get(type_id)
+        body = record[HEADER.size:]
+        if spec is None or len(body) != spec[1]:
+            self.bad_frames += 1
+            return
+        if type_id in self.last_seq:
+            self.gaps[type_id] += (seq - self.last_seq[type_id] - 1) & 0xFF
+        self.last_seq[type_id] = seq
+        self.counts[type_id] += 1
+        self.writers[type_id].writerow(spec[2](t_us, body))
+
+    def close(self):
+        for f in self.files.values():
+            f.close()
+
+    def summary(self):
+        parts = []
+        for type_id, (name, _, _, _) in RECORDS.items():
+            parts.append(f"{name}={self.counts[type_id]} (lost {self.gaps[type_id]})")
+        parts.append(f"bad_frames={self.bad_frames}")
+        return " ".join(parts)
+
+
+def read_serial(port, baud, seconds, decoder, raw_path):
+    try:
+        import serial
+    except ImportError:
+        sys.exit("pyserial is required for --port (pip install pyserial)")
+    raw = open(raw_path, "wb") if raw_path else None
+    with serial.Serial(port, baud, timeout=0.1) as link:
+        deadline = time.monotonic() + seconds
+        while time.monotonic() < deadline:
+            chunk = link.read(4096)
+            if chunk:
+                if raw:
+                    raw.write(chunk)
+                decoder.feed(chunk)
+    if raw:
+        raw.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", nargs="?", help="raw capture file")
+    parser.add_argument("-o", "--out", default="telemetry_csv", help="output directory")
+    parser.add_argument("--port", help="read live from a serial port instead of a file")
+    parser.add_argument("--baud", type=int, default=921600)
+    parser.add_argument("--seconds", type=float, default=30.0)
+    parser.add_argument("--save-raw", help="also write the live capture to this file")
+    args = parser.parse_args()
+
+    if not args.capture and not args.port:
+        parser.error("give a capture file or --port")
+
+    decoder = Decoder(Path(args.out))
+    try:
+        if args.port:
+            read_serial(args.port, args.baud, args.seconds, decoder, args.save_raw)
+        else:
+            with open(args.capture, "rb") as f:
+                while True:
+                    chunk = f.read(65536)
+                    if not chunk:
+                        break
+                    decoder.feed(chunk)
+    finally:
+        decoder.close()
+    print(decoder.summary())
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,107 @@
+#include "ButtonCapture.h"
+
+namespace {
+constexpr uint8_t kButtonPins[] = {37, 39};
+static_assert(sizeof(kButtonPins) == static_cast<size_t>(CapturedButton::Count), "one pin per button");
+
+// Inlined into the handler; digitalRead() itself is in IRAM.
+inline bool readPressed(uint8_t pin) __attribute__((always_inline));
+inline bool readPressed(uint8_t pin) {
+  return digitalRead(pin) == LOW;
+}
+}  // namespace
+
+bool ButtonCapture::begin() {
+  const uint32_t nowUs = micros();
+  for (size_t i = 0; i < static_cast<size_t>(CapturedButton::Count); ++i) {
+    Channel& ch = channels_[i];
+    ch.owner = this;
+    ch.pin = kButtonPins[i];
+    ch.button = static_cast<CapturedButton>(i);
+    pinMode(ch.pin, INPUT);
+    ch.debouncer.reset(readPressed(ch.pin), nowUs);
+    attachInterruptArg(ch.pin, onPinChange, &ch, CHANGE);
+  }
+  ready_ = true;
+  return true;
+}
+
+// GPIO39 also sees the ESP32's short spurious pulses while the ADC powers up; the level read
+// here is back to idle by then, so the debouncer ignores them. Both pins share the one GPIO
+// interrupt, so the handler never runs concurrently with itself.
+void IRAM_ATTR ButtonCapture::onPinChange(void* arg) {
+  Channel* ch = static_cast<Channel*>(arg);
+  ButtonCapture* owner = ch->owner;
+  const uint32_t nowUs = micros();
+  const bool pressed = readPressed(ch->pin);
+  const uint32_t head = owner->rawHead_;
+  if (head - owner->rawTail_ >= kRawDepth) {
+    owner->rawDropped_ = owner->rawDropped_ + 1;
+    return;
+  }
+  ButtonEdge& slot = owner->raw_[head & (kRawDepth - 1)];
+  slot.timeUs = nowUs;
+  slot.button = ch->button;
+  slot.pressed = pressed;
+  __sync_synchronize();  // Slot before head
+  owner->rawHead_ = head + 1;
+}
+
+bool ButtonCapture::pop(ButtonEdge& out) {
+  return queue_.pop(out);
+}
+
+void ButtonCapture::settle(uint32_t nowUs) {
+  if (!ready_) {
+    return;
+  }
+  const uint32_t head = rawHead_;
+  __sync_synchronize();
+  for (uint32_t tail = rawTail_; tail != head; ++tail) {
+    const ButtonEdge raw = raw_[tail & (kRawDepth - 1)];
+    Channel& ch = channels_[static_cast<size_t>(raw.button)];
+    portENTER_CRITICAL(&mux_);
+    const bool accepted = ch.debouncer.edge(raw.pressed, raw.timeUs);
+    portEXIT_CRITICAL(&mux_);
+    if (accepted) {
+      queue_.push(raw);
+    }
+  }
+  __sync_synchronize();  // Slots read before they are handed back
+  rawTail_ = head;
+
+  for (Channel& ch : channels_) {
+    const bool pressed = readPressed(ch.pin);
+    portENTER_CRITICAL(&mux_);
+    const bool changed = ch.debouncer.settle(pressed, nowUs);
+    const uint32_t changedUs = ch.debouncer.changedUs();
+    portEXIT_CRITICAL(&mux_);
+    if (changed) {
+      queue_.push(ButtonEdge{changedUs, ch.button, pressed});
+    }
+  }
+}
+
+bool ButtonCapture::held(CapturedButton button) const {
+  portENTER_CRITICAL(&mux_);
+  const bool pressed = channels_[static_cast<size_t>(button)].debouncer.pressed();
+  portEXIT_CRITICAL(&mux_);
+  return pressed;
+}
+
+bool ButtonCapture::heldAt(CapturedButton button, uint32_t timeUs) const {
+  portENTER_CRITICAL(&mux_);
+  const bool pressed = channels_[static_cast<size_t>(button)].debouncer.pressedAt(timeUs);
+  portEXIT_CRITICAL(&mux_);
+  return pressed;
+}
+
+uint32_t ButtonCapture::bounces() const {
+  uint32_t total = 0;
+  portENTER_CRITICAL(&mux_);
+  for (const Channel& ch : channels_) {
+    total += ch.debouncer.ignored();
+  }
+  portEXIT_CRITICAL(&mux_);
+  return total;
+}
@@ -0,0 +1,71 @@
+#ifndef IMUPOINTER_BUTTON_CAPTURE_H
+#define IMUPOINTER_BUTTON_CAPTURE_H
+
+#include <Arduino.h>
+#include <ButtonDebouncer.h>
+
+#include "SpscRing.h"
+
+enum class CapturedButton : uint8_t {
+  A,  // Front button, GPIO37
+  B,  // Side button, GPIO39
+  Count,
+};
+
+struct ButtonEdge {
+  uint32_t timeUs;  // micros() of the edge that started the bounce burst
+  CapturedButton button;
+  bool pressed;
+};
+
+// Pin-change interrupts on the StickC Plus2 A and B buttons (active-low, external pull-ups).
+// The handler only timestamps each edge and reads the level into a raw buffer; settle() runs
+// the debouncer over them on the loop task, so a press keeps the time it happened at even when
+// the loop was busy. M5.update() still polls the same pins for the menu's click counts and
+// long presses.
+class ButtonCapture {
+ public:
+  static constexpr size_t kQueueDepth = 16;
+  static constexpr uint32_t kRawDepth = 32;  // Two bounce bursts per button between loop passes
+
+  bool begin();
+
+  // Loop task: the oldest debounced edge.
+  bool pop(ButtonEdge& out);
+  // Loop task: debounces the captured edges in order and queues the accepted ones, then any
+  // transition the handler filed as bounce or missed (see ButtonDebouncer::settle).
+  void settle(uint32_t nowUs);
+
+  // Any task. heldAt() answers for a timestamp up to one change back, e.g. an IMU frame that was
+  // sampled just before a press but is processed after it.
+  bool held(CapturedButton button) const;
+  bool heldAt(CapturedButton button, uint32_t timeUs) const;
+
+  uint32_t bounces() const;
+  uint32_t dropped() const { return rawDropped_ + queue_.dropped(); }
+
+ private:
+  static_assert((kRawDepth & (kRawDepth - 1)) == 0, "raw edge buffer must be a power of two");
+
+  struct Channel {
+    ButtonCapture* owner = nullptr;
+    uint8_t pin = 0;
+    CapturedButton button = CapturedButton::A;
+    ButtonDebouncer debouncer;
+  };
+
+  // The handler may run while the flash cache is off (NVS writes), so it touches only IRAM
+  // code and these plain DRAM fields: no debouncer, no SpscRing template.
+  static void IRAM_ATTR onPinChange(void* arg);
+
+  Channel channels_[static_cast<size_t>(CapturedButton::Count)];
+  ButtonEdge raw_[kRawDepth];
+  volatile uint32_t rawHead_ = 0;     // Written by the handler
+  volatile uint32_t rawTail_ = 0;     // Written by settle()
+  volatile uint32_t rawDropped_ = 0;  // Edges lost to a full buffer; settle()'s poll recovers the level
+  SpscRing<ButtonEdge, kQueueDepth> queue_;  // Debounced edges, loop task only
+  mutable portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;  // Debouncer state vs. heldAt() readers
+  bool ready_ = false;
+};
+
+#endif  // IMUPOINTER_BUTTON_CAPTURE_H
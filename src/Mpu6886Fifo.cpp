@@ -0,0 +1,116 @@
+#include "Mpu6886Fifo.h"
+
+#include <M5Unified.h>
+
+namespace {
+constexpr uint8_t kAddress = 0x68;
+constexpr uint32_t kI2cFreq = 400000;
+constexpr size_t kFifoCapacityBytes = 1024;
+
+constexpr uint8_t kRegSmplrtDiv = 0x19;
+constexpr uint8_t kRegConfig = 0x1A;
+constexpr uint8_t kRegGyroConfig = 0x1B;
+constexpr uint8_t kRegAccelConfig = 0x1C;
+constexpr uint8_t kRegAccelConfig2 = 0x1D;
+constexpr uint8_t kRegFifoEn = 0x23;
+constexpr uint8_t kRegUserCtrl = 0x6A;
+constexpr uint8_t kRegFifoCountH = 0x72;
+constexpr uint8_t kRegFifoRw = 0x74;
+
+constexpr uint8_t kConfigFifoStopWhenFull = 0x40;
+// Same ~176 Hz gyro bandwidth (1.9 ms delay) M5Unified configures, so the decimator's 3.5 ms
+// is the only delay added over the polled path and kDeadzoneDps keeps its noise floor.
+constexpr uint8_t kConfigDlpf176Hz = 0x01;         // 1 kHz internal rate
+constexpr uint8_t kGyroFs2000Dps = 0x18;
+constexpr uint8_t kAccelFs8G = 0x10;
+constexpr uint8_t kAccelDlpf99Hz = 0x02;
+constexpr uint8_t kFifoEnGyroAccel = 0x18;
+constexpr uint8_t kUserCtrlFifoEn = 0x40;
+constexpr uint8_t kUserCtrlFifoReset = 0x04;
+}  // namespace
+
+bool Mpu6886Fifo::write(uint8_t reg, uint8_t value) {
+  return M5.In_I2C.writeRegister8(kAddress, reg, value, kI2cFreq);
+}
+
+bool Mpu6886Fifo::begin() {
+  ready_ = false;
+  if (M5.Imu.getType() != m5::imu_t::imu_mpu6886) {
+    return false;
+  }
+  bool ok = true;
+  ok &= write(kRegUserCtrl, 0x00);
+  ok &= write(kRegFifoEn, 0x00);
+  ok &= write(kRegSmplrtDiv, 0x00);
+  odrHz_ = kOdrHz;
+  ok &= write(kRegConfig, kConfigFifoStopWhenFull | kConfigDlpf176Hz);
+  ok &= write(kRegGyroConfig, kGyroFs2000Dps);
+  ok &= write(kRegAccelConfig, kAccelFs8G);
+  ok &= write(kRegAccelConfig2, kAccelDlpf99Hz);
+  ok &= write(kRegUserCtrl, kUserCtrlFifoReset);
+  ok &= write(kRegFifoEn, kFifoEnGyroAccel);
+  ok &= write(kRegUserCtrl, kUserCtrlFifoEn);
+  ready_ = ok;
+  return ok;
+}
+
+void Mpu6886Fifo::reset() {
+  if (!ready_) {
+    return;
+  }
+  write(kRegUserCtrl, kUserCtrlFifoEn | kUserCtrlFifoReset);
+}
+
+bool Mpu6886Fifo::setOutputRate(uint32_t hz) {
+  if (!ready_ || hz == 0 || hz > kOdrHz || (kOdrHz % hz) != 0 || kOdrHz / hz > 256) {
+    return false;
+  }
+  if (hz == odrHz_) {
+    return true;
+  }
+  // ODR = 1 kHz / (1 + SMPLRT_DIV) while the DLPF is enabled.
+  if (!write(kRegSmplrtDiv, static_cast<uint8_t>(kOdrHz / hz - 1))) {
+    return false;
+  }
+  odrHz_ = hz;
+  reset();
+  return true;
+}
+
+size_t Mpu6886Fifo::read(ImuSample* out, size_t maxSamples) {
+  if (!ready_) {
+    return 0;
+  }
+
+  uint8_t countBytes[2] = {0, 0};
+  if (!M5.In_I2C.readRegister(kAddress, kRegFifoCountH, countBytes, sizeof(countBytes), kI2cFreq)) {
+    return 0;
+  }
+  const size_t count = (static_cast<size_t>(countBytes[0] & 0x1F) << 8) | countBytes[1];
+  if (count + kMpu6886FifoFrameBytes > kFifoCapacityBytes) {
+    // Stop-when-full mode: frames were lost, so realign on a fresh FIFO.
+    ++overflows_;
+    reset();
+    return 0;
+  }
+
+  size_t frames = count / kMpu6886FifoFrameBytes;
+  if (frames > maxSamples) {
+    frames = maxSamples;
+  }
+  if (frames > kMaxFramesPerRead) {
+    frames = kMaxFramesPerRead;
+  }
+  if (frames == 0) {
+    return 0;
+  }
+
+  uint8_t buffer[kMaxFramesPerRead * kMpu6886FifoFrameBytes];
+  const size_t bytes = frames * kMpu6886FifoFrameBytes;
+  if (!M5.In_I2C.readRegister(kAddress, kRegFifoRw, buffer, bytes, kI2cFreq)) {
+    reset();  // A partial burst leaves the FIFO misaligned
+    return 0;
+  }
+  burstBytes_ += bytes + sizeof(countBytes);
+  return parseMpu6886Fifo(buffer, bytes, out, frames);
+}
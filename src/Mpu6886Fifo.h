@@ -0,0 +1,42 @@
+#ifndef IMUPOINTER_MPU6886_FIFO_H
+#define IMUPOINTER_MPU6886_FIFO_H
+
+#include <ImuFifo.h>
+
+// Drives the MPU6886 hardware FIFO on the internal I2C bus.
+// The sensor samples at 1 kHz (or a divided rate while idle); each poll drains every buffered
+// frame in one burst.
+class Mpu6886Fifo {
+ public:
+  static constexpr uint32_t kOdrHz = 1000;
+  static constexpr size_t kMaxFramesPerRead = 32;
+
+  // Reconfigures sample rate, DLPF and FIFO. Keeps the full-scale ranges M5Unified expects,
+  // so M5.Imu.getGyroData()/getAccelData() remain valid. Returns false if the chip is not an MPU6886.
+  bool begin();
+  bool ready() const { return ready_; }
+
+  // Reads all complete frames currently buffered. Returns the number of samples written.
+  size_t read(ImuSample* out, size_t maxSamples);
+
+  // Discards buffered frames (e.g. after the motion task was paused).
+  void reset();
+
+  // Divides the 1 kHz internal rate down to hz (1000 / hz must be an integer in 1..256)
+  // and flushes the FIFO so no frames of the old rate are returned.
+  bool setOutputRate(uint32_t hz);
+  uint32_t outputRate() const { return odrHz_; }
+
+  uint32_t overflows() const { return overflows_; }
+  uint32_t burstBytes() const { return burstBytes_; }
+
+ private:
+  bool write(uint8_t reg, uint8_t value);
+
+  bool ready_ = false;
+  uint32_t odrHz_ = kOdrHz;
+  uint32_t overflows_ = 0;
+  uint32_t burstBytes_ = 0;
+};
+
+#endif  // IMUPOINTER_MPU6886_FIFO_H
@@ -0,0 +1,83 @@
+#include "StageProfiler.h"
+
+namespace {
+// Budgets are per call. Loop stages share a 1 ms tick; the motion task has 4 ms;
+// UI stages run every 10 ms and may block on flash or the display queue.
+const StageInfo kStageInfo[kProfileStageCount] = {
+  {"m5", 150},
+  {"btn", 100},
+  {"drain", 150},
+  {"clicks", 150},
+  {"hid", 600},
+  {"misc", 100},
+  {"motion", 1500},
+  {"gesture", 100},
+  {"battery", 2000},
+  {"debug", 5000},
+  {"telemetry", 1000},
+  {"persist", 30000},
+  {"display", 5000},
+};
+
+#if IMUPOINTER_PROFILE
+struct StageSlot {
+  StageStats stats;
+  uint32_t budgetCycles;
+  volatile bool resetRequested;
+};
+
+StageSlot g_stages[kProfileStageCount];
+
+void clearStats(StageStats& stats) {
+  stats.calls = 0;
+  stats.minCycles = UINT32_MAX;
+  stats.maxCycles = 0;
+  stats.sumCycles = 0;
+  stats.overruns = 0;
+}
+#endif
+}  // namespace
+
+const StageInfo& profileStageInfo(ProfileStage stage) {
+  return kStageInfo[static_cast<size_t>(stage)];
+}
+
+#if IMUPOINTER_PROFILE
+
+void profileBegin() {
+  const uint32_t cyclesPerUs = ESP.getCpuFreqMHz();
+  for (size_t i = 0; i < kProfileStageCount; ++i) {
+    clearStats(g_stages[i].stats);
+    g_stages[i].budgetCycles = kStageInfo[i].budgetUs * cyclesPerUs;
+    g_stages[i].resetRequested = false;
+  }
+}
+
+void profileRecord(ProfileStage stage, uint32_t cycles) {
+  StageSlot& slot = g_stages[static_cast<size_t>(stage)];
+  StageStats& s = slot.stats;
+  // Only the writing task clears the window, so no lock is needed.
+  if (slot.resetRequested) {
+    slot.resetRequested = false;
+    clearStats(s);
+  }
+  ++s.calls;
+  s.sumCycles += cycles;
+  s.minCycles = (cycles < s.minCycles) ? cycles : s.minCycles;
+  s.maxCycles = (cycles > s.maxCycles) ? cycles : s.maxCycles;
+  if (cycles > slot.budgetCycles) {
+    ++s.overruns;
+  }
+}
+
+StageStats profileTake(ProfileStage stage) {
+  StageSlot& slot = g_stages[static_cast<size_t>(stage)];
+  StageStats out = slot.stats;
+  if (out.calls == 0) {
+    out.minCycles = 0;
+  }
+  slot.resetRequested = true;
+  return out;
+}
+
+#endif  // IMUPOINTER_PROFILE
@@ -0,0 +1,83 @@
+#ifndef IMUPOINTER_STAGE_PROFILER_H
+#define IMUPOINTER_STAGE_PROFILER_H
+
+#include <Arduino.h>
+
+// Off unless built with -DIMUPOINTER_PROFILE=1 (the m5stickc_plus2_profile env); when off,
+// every PROFILE_STAGE() scope compiles out.
+#ifndef IMUPOINTER_PROFILE
+#define IMUPOINTER_PROFILE 0
+#endif
+
+enum class ProfileStage : uint8_t {
+  LoopM5Update,
+  LoopButtons,
+  LoopDrainMotion,
+  LoopClicks,
+  LoopHidService,
+  LoopHousekeeping,
+  MotionUpdate,
+  MotionGesture,  // Nested inside MotionUpdate
+  UiBattery,
+  UiDebug,
+  UiTelemetry,
+  UiPersistence,
+  UiDisplay,
+  Count,
+};
+
+constexpr size_t kProfileStageCount = static_cast<size_t>(ProfileStage::Count);
+
+// Per-stage cycle statistics for the current window. Each stage is written by exactly one
+// task and read by the UI task; fields are word-sized, so a read never tears a value but may
+// mix two consecutive updates.
+struct StageStats {
+  uint32_t calls;
+  uint32_t minCycles;
+  uint32_t maxCycles;
+  uint32_t sumCycles;  // Window is ~1 s, far below the 17 s wrap at 240 MHz
+  uint32_t overruns;   // Calls longer than the stage budget
+};
+
+struct StageInfo {
+  const char* name;
+  uint32_t budgetUs;
+};
+
+const StageInfo& profileStageInfo(ProfileStage stage);
+
+#if IMUPOINTER_PROFILE
+
+void profileBegin();  // Converts the per-stage budgets to cycles at the current CPU clock
+void profileRecord(ProfileStage stage, uint32_t cycles);
+// Returns the window's statistics and asks the writer to start a new window.
+StageStats profileTake(ProfileStage stage);
+
+class ScopedStageTimer {
+ public:
+  explicit ScopedStageTimer(ProfileStage stage) : stage_(stage), start_(ESP.getCycleCount()) {}
+  ~ScopedStageTimer() { profileRecord(stage_, ESP.getCycleCount() - start_); }
+
+  ScopedStageTimer(const ScopedStageTimer&) = delete;
+  ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+ private:
+  ProfileStage stage_;
+  uint32_t start_;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_STAGE(stage) ScopedStageTimer PROFILE_CONCAT(profileScope_, __LINE__)(stage)
+
+#else
+
+inline void profileBegin() {}
+inline StageStats profileTake(ProfileStage) { return StageStats(); }
+#define PROFILE_STAGE(stage) \
+  do {                       \
+  } while (0)
+
+#endif  // IMUPOINTER_PROFILE
+
+#endif  // IMUPOINTER_STAGE_PROFILER_H
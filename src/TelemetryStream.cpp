@@ -0,0 +1,28 @@
+#include "TelemetryStream.h"
+
+bool TelemetryStream::push(const void* record, size_t length) {
+  Slot slot;
+  slot.length = static_cast<uint8_t>(encodeTelemetryFrame(record, length, slot.bytes, sizeof(slot.bytes)));
+  if (slot.length == 0) {
+    return false;
+  }
+  return ring_.push(slot);
+}
+
+size_t TelemetryStream::drain(HardwareSerial& port) {
+  // Whole frames only, so frames from the other stream or a log line never land mid-frame.
+  size_t written = 0;
+  for (;;) {
+    if (!pendingFrame_) {
+      if (!ring_.pop(current_)) {
+        return written;
+      }
+      pendingFrame_ = true;
+    }
+    if (port.availableForWrite() < static_cast<int>(current_.length)) {
+      return written;
+    }
+    written += port.write(current_.bytes, current_.length);
+    pendingFrame_ = false;
+  }
+}
@@ -0,0 +1,44 @@
+#ifndef IMUPOINTER_TELEMETRY_STREAM_H
+#define IMUPOINTER_TELEMETRY_STREAM_H
+
+#include <Arduino.h>
+#include <TelemetryFrame.h>
+
+#include "SpscRing.h"
+
+// One producer task's queue of encoded telemetry frames. write() encodes into a ring slot and
+// never blocks; drain() (one consumer task) writes only whole frames the UART TX buffer can take.
+class TelemetryStream {
+ public:
+  static constexpr size_t kSlots = 64;  // ~50 ms of 1 kHz IMU frames plus pipeline output
+
+  template <typename Record>
+  bool write(Record& record, uint32_t timeUs) {
+    static_assert(sizeof(Record) <= kTelemetryMaxRecordBytes, "telemetry record too large");
+    const uint8_t type = static_cast<uint8_t>(Record::kType);
+    record.header.type = type;
+    record.header.seq = seq_[type & 0x07]++;
+    record.header.timeUs = timeUs;
+    return push(&record, sizeof(record));
+  }
+
+  // Consumer side. Returns the number of bytes handed to the port.
+  size_t drain(HardwareSerial& port);
+
+  uint32_t dropped() const { return ring_.dropped(); }
+
+ private:
+  struct Slot {
+    uint8_t length;
+    uint8_t bytes[kTelemetryMaxFrameBytes];
+  };
+
+  bool push(const void* record, size_t length);
+
+  SpscRing<Slot, kSlots> ring_;
+  uint8_t seq_[8] = {};
+  Slot current_ = {};  // Popped frame waiting for TX room
+  bool pendingFrame_ = false;
+};
+
+#endif  // IMUPOINTER_TELEMETRY_STREAM_H
@@ -0,0 +1,1070 @@
+// Native benchmark for MotionPipeline: `pio run -e native -t exec`.
+// Drives each stage over a synthetic 250 Hz trace and reports ns/sample and heap
+// allocations, then compares the pointer filter against the previous fixed EMA for lag and
+// jitter on synthetic step, ramp and hold inputs, and scores the latency predictor and the
+// gesture recognizer. Also checks the IMU FIFO parser and decimator against known frames, the
+// orientation filter and pointingRates() against synthetic rigid-body rotations, the
+// temperature bias model on a synthetic warm-up ramp, and replays synthetic bouncing button presses through the debouncer.
+// Pass an imu.csv from scripts/telemetry_decode.py to score the predictor on a recording, and
+// a labels file (start_us,end_us,gesture per line) to score the gesture recognizer on it too:
+//   .pio/build/native/program capture/imu.csv [capture/gestures.csv]
+// Built only in the native environment (see platformio.ini).
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include <BallisticsProfile.h>
+#include <ButtonDebouncer.h>
+#include <FastMath.h>
+#include <GestureRecognizer.h>
+#include <ImuFifo.h>
+#include <MotionPipeline.h>
+#include <MotionPredictor.h>
+#include <OneEuroFilter.h>
+#include <OrientationFilter.h>
+#include <TempBiasModel.h>
+
+namespace {
+size_t g_allocations = 0;
+
+constexpr float kSampleDt = 0.004f;
+constexpr size_t kTraceSamples = 250 * 60;  // One minute at the motion rate
+constexpr int kRepeats = 40;
+
+// Mix of hand pointing, a click-and-drag, scrolling and the stick lying on the desk.
+std::vector<MotionInput> makeTrace() {
+  std::vector<MotionInput> trace(kTraceSamples);
+  uint32_t seed = 12345;
+  for (size_t i = 0; i < kTraceSamples; ++i) {
+    MotionInput& in = trace[i];
+    const float t = static_cast<float>(i) * kSampleDt;
+    const size_t phase = (i / 2500) % 6;  // 10 s segments
+    seed = seed * 1664525u + 1013904223u;
+    const float noise = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 0.8f;
+    in.timestampMs = static_cast<uint32_t>(i * 4);
+    in.dt = kSampleDt;
+    in.haveAccel = true;
+    if (phase == 4) {
+      // Flat on the desk: only sensor noise.
+      in.gx = noise;
+      in.gy = noise * 0.5f;
+      in.gz = -noise;
+      in.az = 1.0f;
+    } else {
+      in.gx = 60.0f * sinf(t * 2.1f) + noise;
+      in.gy = 8.0f * sinf(t * 0.7f) + noise;
+      in.gz = 90.0f * sinf(t * 1.3f) - noise;
+      in.ax = 0.15f * sinf(t * 0.9f);
+      in.ay = 0.55f;
+      in.az = 0.8f;
+    }
+    in.upX = 0.0f;
+    in.upY = 0.55f;
+    in.upZ = 0.835f;
+    in.buttons.left = phase == 2 && (i % 2500) > 250;
+    in.buttons.scroll = phase == 3;
+  }
+  return trace;
+}
+
+// The fixed low-pass the pipeline used before OneEuroFilter: alpha 0.12 per sample,
+// i.e. a ~5.4 Hz cutoff at 250 Hz.
+struct EmaReference {
+  float alpha = 0.12f;
+  float value = 0.0f;
+  void update(float in, float /*speedDps*/, float /*dt*/) { value += alpha * (in - value); }
+  float out() const { return value; }
+};
+
+struct OneEuroAxis {
+  OneEuroFilter filter;
+  void update(float in, float speedDps, float dt) { filter.update(in, 0.0f, speedDps, dt); }
+  float out() const { return filter.x(); }
+};
+
+struct FilterScore {
+  float stepFastMs;  // 10-90% rise for a 0 -> 150 dps step
+  float stepSlowMs;  // 10-90% rise for a 0 -> 10 dps step (fine aiming)
+  float rampLagMs;   // Steady-state delay behind a 300 dps/s ramp
+  float holdRmsDps;  // Output RMS while holding still with tremor and sensor noise
+};
+
+template <typename Filter>
+float riseTimeMs(float stepDps) {
+  Filter f;
+  const float deadzone = MotionPipeline::Config().deadzoneDps;
+  float t10 = -1.0f;
+  for (int i = 0; i < 250; ++i) {
+    const float in = MotionPipeline::deadzone(stepDps, deadzone);
+    f.update(in, fabsf(in), kSampleDt);
+    const float t = (i + 1) * kSampleDt * 1000.0f;
+    if (t10 < 0.0f && f.out() >= 0.1f * stepDps) {
+      t10 = t;
+    }
+    if (f.out() >= 0.9f * stepDps) {
+      return t - t10;
+    }
+  }
+  return 1000.0f;
+}
+
+template <typename Filter>
+FilterScore scoreFilter() {
+  FilterScore score;
+  score.stepFastMs = riseTimeMs<Filter>(150.0f);
+  score.stepSlowMs = riseTimeMs<Filter>(10.0f);
+
+  // Ramp: after 0.5 s the output trails the input by slope * delay.
+  constexpr float kSlopeDpsPerS = 300.0f;
+  Filter ramp;
+  double lagSum = 0.0;
+  int lagCount = 0;
+  for (int i = 0; i < 250; ++i) {
+    const float in = kSlopeDpsPerS * (i + 1) * kSampleDt;
+    ramp.update(in, in, kSampleDt);
+    if (i >= 125) {
+      lagSum += (in - ramp.out()) / kSlopeDpsPerS * 1000.0f;
+      ++lagCount;
+    }
+  }
+  score.rampLagMs = static_cast<float>(lagSum / lagCount);
+
+  // Hold: 9 Hz physiological tremor plus white noise, through the deadzone like the pipeline.
+  Filter hold;
+  const float deadzone = MotionPipeline::Config().deadzoneDps;
+  uint32_t seed = 777;
+  double sumSq = 0.0;
+  const int samples = 250 * 4;
+  for (int i = 0; i < samples; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    const float noise = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 2.0f;
+    const float raw = 2.0f * sinf(2.0f * 3.14159265f * 9.0f * i * kSampleDt) + noise;
+    const float in = MotionPipeline::deadzone(raw, deadzone);
+    hold.update(in, fabsf(in), kSampleDt);
+    sumSq += static_cast<double>(hold.out()) * hold.out();
+  }
+  score.holdRmsDps = static_cast<float>(sqrt(sumSq / samples));
+  return score;
+}
+
+void printFilterScore(const char* name, const FilterScore& score) {
+  printf("%-12s %10.1f %10.1f %10.1f %10.3f\n", name, score.stepFastMs, score.stepSlowMs, score.rampLagMs,
+         score.holdRmsDps);
+}
+
+// Deadzoned pointing rates at the motion rate, the input to the predictor evaluation.
+// timeUs is only filled for recordings.
+struct RateTrace {
+  std::vector<float> yaw;
+  std::vector<float> pitch;
+  std::vector<uint32_t> timeUs;
+};
+
+// Hand-like pointing: slow wandering aim, faster oscillation and a 200 dps flick every 3 s.
+RateTrace makeSyntheticRates() {
+  RateTrace trace;
+  const float deadzone = MotionPipeline::Config().deadzoneDps;
+  uint32_t seed = 4242;
+  for (size_t i = 0; i < 250 * 30; ++i) {
+    const float t = static_cast<float>(i) * kSampleDt;
+    seed = seed * 1664525u + 1013904223u;
+    const float noise = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 1.6f;
+    const float phase = fmodf(t, 3.0f);
+    const float flick = (phase < 0.3f) ? 200.0f * sinf(phase / 0.3f * 3.14159265f) : 0.0f;
+    const float yaw = 80.0f * sinf(t * 2.3f) * sinf(t * 0.37f) + 40.0f * sinf(t * 5.1f + 1.0f) + flick;
+    const float pitch = 50.0f * sinf(t * 1.7f) * sinf(t * 0.23f) + 20.0f * sinf(t * 4.3f);
+    trace.yaw.push_back(MotionPipeline::deadzone(yaw + noise, deadzone));
+    trace.pitch.push_back(MotionPipeline::deadzone(pitch - noise, deadzone));
+  }
+  return trace;
+}
+
+// Replays 1 kHz frames (imu.csv from scripts/telemetry_decode.py) through the firmware's
+// orientation filter and decimator. The first 0.5 s is taken as gyro bias, so start the
+// capture with the stick held still.
+bool loadRecordedRates(const char* path, RateTrace& trace) {
+  FILE* file = fopen(path, "r");
+  if (file == nullptr) {
+    return false;
+  }
+  std::vector<ImuSample> frames;
+  std::vector<uint32_t> frameUs;
+  char line[256];
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    ImuSample s;
+    unsigned long timeUs = 0;
+    if (sscanf(line, "%lu,%f,%f,%f,%f,%f,%f,%f", &timeUs, &s.gx, &s.gy, &s.gz, &s.ax, &s.ay, &s.az,
+               &s.tempC) == 8) {
+      frames.push_back(s);
+      frameUs.push_back(static_cast<uint32_t>(timeUs));
+    }
+  }
+  fclose(file);
+  const size_t biasFrames = 500;
+  if (frames.size() < biasFrames * 2) {
+    return false;
+  }
+  float bias[3] = {0.0f, 0.0f, 0.0f};
+  for (size_t i = 0; i < biasFrames; ++i) {
+    bias[0] += frames[i].gx / biasFrames;
+    bias[1] += frames[i].gy / biasFrames;
+    bias[2] += frames[i].gz / biasFrames;
+  }
+
+  const float deadzone = MotionPipeline::Config().deadzoneDps;
+  OrientationFilter orientation;
+  ImuDecimator decimator;
+  for (size_t i = 0; i < frames.size(); ++i) {
+    ImuSample frame = frames[i];
+    frame.gx -= bias[0];
+    frame.gy -= bias[1];
+    frame.gz -= bias[2];
+    orientation.update(frame, 0.001f);
+    ImuSample sample;
+    if (!decimator.push(frame, sample)) {
+      continue;
+    }
+    float upX = 0.0f;
+    float upY = 0.0f;
+    float upZ = 1.0f;
+    orientation.upVector(upX, upY, upZ);
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+    pointingRates(upX, upY, upZ, sample.gx, sample.gy, sample.gz, yaw, pitch);
+    trace.yaw.push_back(MotionPipeline::deadzone(yaw, deadzone));
+    trace.pitch.push_back(MotionPipeline::deadzone(pitch, deadzone));
+    trace.timeUs.push_back(frameUs[i]);
+  }
+  return true;
+}
+
+struct ChainScore {
+  float delayMs;  // Shift that best aligns output with the input rates
+  float rmsDps;   // Residual error once aligned: noise, overshoot and shape distortion
+};
+
+// Rates through predictor + filter, as the pipeline runs them (before gain and quantization).
+RateTrace runChain(const RateTrace& in, float horizonMs) {
+  MotionPredictor::Config config;
+  config.horizonMs = horizonMs;
+  MotionPredictor predictor(config);
+  OneEuroFilter filter;
+  RateTrace out;
+  for (size_t i = 0; i < in.yaw.size(); ++i) {
+    const float speed = sqrtf(in.yaw[i] * in.yaw[i] + in.pitch[i] * in.pitch[i]);
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+    predictor.update(in.yaw[i], in.pitch[i], kSampleDt, yaw, pitch);
+    filter.update(yaw, pitch, speed, kSampleDt);
+    out.yaw.push_back(filter.x());
+    out.pitch.push_back(filter.y());
+  }
+  return out;
+}
+
+ChainScore scoreChain(const RateTrace& ref, const RateTrace& out) {
+  constexpr int kMinShift = -10;
+  constexpr int kMaxShift = 30;
+  float errors[kMaxShift - kMinShift + 1];
+  int best = 0;
+  for (int shift = kMinShift; shift <= kMaxShift; ++shift) {
+    double sumSq = 0.0;
+    size_t n = 0;
+    for (size_t t = kMaxShift; t + static_cast<size_t>(-kMinShift) < ref.yaw.size(); ++t) {
+      const double dy = out.yaw[t] - ref.yaw[t - shift];
+      const double dp = out.pitch[t] - ref.pitch[t - shift];
+      sumSq += dy * dy + dp * dp;
+      ++n;
+    }
+    errors[shift - kMinShift] = static_cast<float>(sqrt(sumSq / (n ? n : 1)));
+    if (errors[shift - kMinShift] < errors[best - kMinShift] || shift == kMinShift) {
+      best = shift;
+    }
+  }
+  // Parabolic refinement between 4 ms samples.
+  float frac = 0.0f;
+  if (best > kMinShift && best < kMaxShift) {
+    const float a = errors[best - kMinShift - 1];
+    const float b = errors[best - kMinShift];
+    const float c = errors[best - kMinShift + 1];
+    const float den = a - 2.0f * b + c;
+    frac = (den > 0.0f) ? 0.5f * (a - c) / den : 0.0f;
+  }
+  ChainScore score;
+  score.delayMs = (best + frac) * kSampleDt * 1000.0f;
+  score.rmsDps = errors[best - kMinShift];
+  return score;
+}
+
+void printPredictorScores(const char* source, const RateTrace& rates) {
+  printf("\npredictor vs %s rates (%zu samples; delay = best-fit lag behind the input)\n", source, rates.yaw.size());
+  printf("%-10s %10s %10s %10s %10s\n", "horizon", "delay_ms", "removed", "rms_dps", "added");
+  const ChainScore base = scoreChain(rates, runChain(rates, 0.0f));
+  const float horizons[] = {0.0f, 4.0f, 8.0f, 12.0f, 16.0f};
+  for (float h : horizons) {
+    const ChainScore score = scoreChain(rates, runChain(rates, h));
+    printf("%7.0f ms %10.1f %10.1f %10.2f %9.0f%%\n", h, score.delayMs, base.delayMs - score.delayMs,
+           score.rmsDps, (score.rmsDps / base.rmsDps - 1.0f) * 100.0f);
+  }
+}
+
+// A performed gesture: the recognizer should report it between startUs and endUs plus
+// kGestureReportSlackUs.
+struct GestureLabel {
+  uint32_t startUs;
+  uint32_t endUs;
+  Gesture gesture;
+};
+
+struct GestureTrace {
+  RateTrace rates;
+  std::vector<GestureLabel> labels;
+};
+
+constexpr uint32_t kGestureReportSlackUs = 400000;
+
+float uniform(uint32_t& seed, float lo, float hi) {
+  seed = seed * 1664525u + 1013904223u;
+  return lo + (hi - lo) * (static_cast<float>(seed >> 8) / 16777216.0f);
+}
+
+// Hand-drawn gestures with randomized speed, size, shape and start direction over wandering
+// pointing motion, plus decoys every few slots: fast one-way sweeps, a sweep followed by a slow
+// return, and slow wiggles. Rates are in the firmware's yaw/pitch convention (x = -yaw).
+GestureTrace makeGestureTrace() {
+  constexpr float kPi = 3.14159265f;
+  constexpr float kSlotS = 2.5f;
+  constexpr size_t kSlots = 240;  // 10 minutes
+  const size_t samples = static_cast<size_t>(kSlots * kSlotS / kSampleDt);
+  GestureTrace trace;
+  // Built in screen axes (x right, y down) and converted to yaw at the end.
+  std::vector<float>& x = trace.rates.yaw;
+  std::vector<float>& y = trace.rates.pitch;
+  x.resize(samples);
+  y.resize(samples);
+  uint32_t seed = 9001;
+  for (size_t i = 0; i < samples; ++i) {
+    const float t = static_cast<float>(i) * kSampleDt;
+    x[i] = 35.0f * sinf(t * 1.9f) * sinf(t * 0.31f) + 15.0f * sinf(t * 4.7f) + uniform(seed, -3.0f, 3.0f);
+    y[i] = 25.0f * sinf(t * 1.3f) * sinf(t * 0.17f) + 10.0f * sinf(t * 3.9f) + uniform(seed, -3.0f, 3.0f);
+  }
+
+  auto add = [&](float startS, float durationS, float (*shape)(float, float, float, float, float&), float a,
+                 float b, float c) {
+    const size_t first = static_cast<size_t>(startS / kSampleDt);
+    const size_t count = static_cast<size_t>(durationS / kSampleDt);
+    for (size_t i = 0; i < count && first + i < samples; ++i) {
+      float dy = 0.0f;
+      x[first + i] += shape(static_cast<float>(i) / count, a, b, c, dy);
+      y[first + i] += dy;
+    }
+  };
+  // Flick: raised-sine out over fraction a of the span, back over the rest; b = peak dps,
+  // c = vertical share.
+  auto flick = [](float u, float split, float peak, float vertical, float& dy) -> float {
+    const float v = (u < split) ? peak * sinf(kPi * u / split)
+                                : -peak * split / (1.0f - split) * sinf(kPi * (u - split) / (1.0f - split));
+    dy = v * vertical;
+    return v;
+  };
+  // Circle: a = turns (signed for direction), b = speed dps, c = start direction in radians.
+  auto circle = [](float u, float turns, float speed, float phase, float& dy) -> float {
+    const float angle = phase + 2.0f * kPi * turns * u;
+    dy = 0.8f * speed * sinf(angle);
+    return speed * cosf(angle);
+  };
+  // One-way sweep: raised sine with no return.
+  auto sweep = [](float u, float peak, float vertical, float, float& dy) -> float {
+    const float v = peak * sinf(kPi * u);
+    dy = v * vertical;
+    return v;
+  };
+  auto wiggle = [](float u, float peak, float cycles, float, float& dy) -> float {
+    dy = 0.0f;
+    return peak * sinf(2.0f * kPi * cycles * u);
+  };
+
+  for (size_t slot = 0; slot < kSlots; ++slot) {
+    const float startS = slot * kSlotS + uniform(seed, 0.3f, 0.8f);
+    const int kind = static_cast<int>(uniform(seed, 0.0f, 5.0f));
+    GestureLabel label;
+    label.startUs = static_cast<uint32_t>(startS * 1e6f);
+    if (kind <= 1) {
+      const float side = kind == 0 ? -1.0f : 1.0f;
+      const float duration = uniform(seed, 0.28f, 0.6f);
+      add(startS, duration, flick, uniform(seed, 0.3f, 0.5f), side * uniform(seed, 180.0f, 500.0f),
+          uniform(seed, -0.25f, 0.25f));
+      label.endUs = static_cast<uint32_t>((startS + duration) * 1e6f);
+      label.gesture = kind == 0 ? Gesture::FlickLeft : Gesture::FlickRight;
+      trace.labels.push_back(label);
+    } else if (kind == 2) {
+      const float turns = uniform(seed, 1.0f, 1.3f) * (uniform(seed, 0.0f, 1.0f) < 0.5f ? -1.0f : 1.0f);
+      const float duration = fabsf(turns) * uniform(seed, 0.7f, 1.2f);
+      add(startS, duration, circle, turns, uniform(seed, 60.0f, 160.0f), uniform(seed, 0.0f, 2.0f * kPi));
+      label.endUs = static_cast<uint32_t>((startS + duration) * 1e6f);
+      label.gesture = Gesture::Circle;
+      trace.labels.push_back(label);
+    } else if (kind == 3) {
+      const float peak = uniform(seed, 200.0f, 500.0f) * (uniform(seed, 0.0f, 1.0f) < 0.5f ? -1.0f : 1.0f);
+      add(startS, uniform(seed, 0.15f, 0.4f), sweep, peak, uniform(seed, -0.5f, 0.5f), 0.0f);
+      if (uniform(seed, 0.0f, 1.0f) < 0.5f) {
+        add(startS + 0.9f, 1.2f, sweep, -peak * 0.12f, 0.0f, 0.0f);  // Slow walk back
+      }
+    } else {
+      add(startS, 1.5f, wiggle, uniform(seed, 40.0f, 90.0f), uniform(seed, 1.0f, 3.0f), 0.0f);
+    }
+  }
+
+  for (size_t i = 0; i < samples; ++i) {
+    x[i] = -x[i];
+    trace.rates.timeUs.push_back(static_cast<uint32_t>(i * 4000u));
+  }
+  return trace;
+}
+
+// Labels for a recording: start_us,end_us,name per line, in imu.csv time, with names as
+// printed by gestureName().
+bool loadGestureLabels(const char* path, std::vector<GestureLabel>& labels) {
+  FILE* file = fopen(path, "r");
+  if (file == nullptr) {
+    return false;
+  }
+  char line[128];
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    unsigned long startUs = 0;
+    unsigned long endUs = 0;
+    char name[32];
+    if (sscanf(line, "%lu,%lu,%31s", &startUs, &endUs, name) != 3) {
+      continue;
+    }
+    for (size_t g = 1; g < kGestureCount; ++g) {
+      if (strcmp(name, gestureName(static_cast<Gesture>(g))) == 0) {
+        labels.push_back({static_cast<uint32_t>(startUs), static_cast<uint32_t>(endUs), static_cast<Gesture>(g)});
+      }
+    }
+  }
+  fclose(file);
+  return !labels.empty();
+}
+
+// Runs the recognizer over a labelled trace and prints per-gesture hits, confusions and
+// misses, false reports per minute outside any label, and the cost per motion sample.
+void printGestureScores(const char* source, const RateTrace& rates, const std::vector<GestureLabel>& labels) {
+  struct Report {
+    uint32_t timeUs;
+    Gesture gesture;
+  };
+  std::vector<Report> reports;
+  reports.reserve(labels.size() * 2 + 16);
+  GestureRecognizer recognizer;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rates.yaw.size(); ++i) {
+    const Gesture g = recognizer.update(-rates.yaw[i], rates.pitch[i], kSampleDt);
+    if (g != Gesture::None) {
+      reports.push_back({rates.timeUs[i], g});
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const double nsPerSample =
+      std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(rates.yaw.size());
+
+  size_t count[kGestureCount] = {};
+  size_t hit[kGestureCount] = {};
+  size_t wrong[kGestureCount] = {};
+  std::vector<bool> used(reports.size(), false);
+  for (const GestureLabel& label : labels) {
+    const size_t g = static_cast<size_t>(label.gesture);
+    ++count[g];
+    bool matched = false;
+    for (size_t r = 0; r < reports.size() && !matched; ++r) {
+      if (!used[r] && reports[r].timeUs >= label.startUs && reports[r].timeUs <= label.endUs + kGestureReportSlackUs) {
+        used[r] = true;
+        matched = true;
+        ++(reports[r].gesture == label.gesture ? hit[g] : wrong[g]);
+      }
+    }
+  }
+  size_t falseReports = 0;
+  for (bool u : used) {
+    falseReports += u ? 0 : 1;
+  }
+  const float minutes = rates.yaw.size() * kSampleDt / 60.0f;
+
+  printf("\ngestures vs %s (%zu labels, %.1f min)\n", source, labels.size(), minutes);
+  printf("%-12s %6s %6s %6s %6s\n", "gesture", "n", "hit", "wrong", "miss");
+  for (size_t g = 1; g < kGestureCount; ++g) {
+    printf("%-12s %6zu %6zu %6zu %6zu\n", gestureName(static_cast<Gesture>(g)), count[g], hit[g], wrong[g],
+           count[g] - hit[g] - wrong[g]);
+  }
+  printf("false reports: %zu (%.2f/min); cost %.1f ns/sample; state %zu bytes\n", falseReports,
+         falseReports / minutes, nsPerSample, sizeof(GestureRecognizer));
+}
+
+// Parameters the ballistics tables are generated from (see BallisticsProfile.cpp), for the
+// libm reference.
+struct BallisticsReference {
+  float curveGain;
+  float refDps;
+  float exponent;
+};
+constexpr BallisticsReference kBallisticsReference[kBallisticsProfileCount] = {
+  {0.28f, 120.0f, 1.35f},
+  {0.45f, 160.0f, 1.60f},
+  {0.10f, 200.0f, 1.00f},
+  {1.60f, 180.0f, 1.80f},
+};
+
+// Dense host check of the FastMath helpers and ballistics tables against libm; the table
+// bound is also enforced by static_assert in BallisticsProfile.cpp. Returns false when a bound
+// is exceeded.
+bool checkFastMath() {
+  double curveErr = 0.0;
+  for (size_t p = 0; p < kBallisticsProfileCount; ++p) {
+    const BallisticsReference& ref = kBallisticsReference[p];
+    for (int i = 0; i <= 400000; ++i) {
+      const float speed = static_cast<float>(i) * 0.001f;  // 0..400 dps
+      const float norm = fminf(speed / ref.refDps, 1.0f);
+      const double exact = 1.0 + ref.curveGain * pow(norm, ref.exponent);
+      curveErr = fmax(curveErr, fabs(kBallisticsProfiles[p].gainAt(speed) - exact));
+    }
+  }
+  double rsqrtErr = 0.0;
+  for (float x = 1.0e-6f; x < 1.0e7f; x *= 1.0001f) {
+    rsqrtErr = fmax(rsqrtErr, fabs(fastRsqrt(x) * sqrt(static_cast<double>(x)) - 1.0));
+  }
+  long roundMismatch = 0;
+  for (int i = -4000000; i <= 4000000; ++i) {
+    const float v = static_cast<float>(i) * 0.00025f;
+    roundMismatch += (roundToLong(v) != lroundf(v)) ? 1 : 0;
+  }
+  const bool ok = curveErr < 1.0e-3 && rsqrtErr < 5.0e-6 && roundMismatch == 0;
+  printf("\nfast math vs libm: gain_abs_err=%.2e rsqrt_rel_err=%.2e round_mismatch=%ld -> %s\n", curveErr,
+         rsqrtErr, roundMismatch, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+void putBe16(uint8_t* p, int16_t value) {
+  p[0] = static_cast<uint8_t>(static_cast<uint16_t>(value) >> 8);
+  p[1] = static_cast<uint8_t>(value & 0xFF);
+}
+
+// FIFO frame parser and 4:1 decimator: byte order and scaling, partial frames and the output
+// clamp, then the FIR's DC gain, output cadence, group delay and warm-up pass-through.
+bool checkImuFifo() {
+  // Raw words with distinct high and low bytes, so swapped bytes cannot decode right.
+  const int16_t raw[7] = {0x1234, -0x2000, 0x1000, 0x0CC4, 0x0148, -0x0A40, 0x7FF0};
+  uint8_t burst[3 * kMpu6886FifoFrameBytes + 5];
+  for (size_t f = 0; f < 3; ++f) {
+    for (size_t w = 0; w < 7; ++w) {
+      putBe16(burst + f * kMpu6886FifoFrameBytes + 2 * w, static_cast<int16_t>(raw[w] + f));
+    }
+  }
+  memset(burst + 3 * kMpu6886FifoFrameBytes, 0xAB, 5);
+  ImuSample parsed[4];
+  const size_t whole = parseMpu6886Fifo(burst, sizeof(burst), parsed, 4);
+  const ImuSample& s = parsed[0];
+  const bool scaleOk = fabsf(s.ax - 0x1234 / 4096.0f) < 1e-6f && fabsf(s.ay + 2.0f) < 1e-6f &&
+                       fabsf(s.az - 1.0f) < 1e-6f && fabsf(s.tempC - (0x0CC4 / 326.8f + 25.0f)) < 1e-4f &&
+                       fabsf(s.gx - 20.0f) < 1e-4f && fabsf(s.gy + 160.0f) < 1e-3f &&
+                       fabsf(s.gz - 0x7FF0 / 16.4f) < 1e-3f && fabsf(parsed[2].gx - (0x0148 + 2) / 16.4f) < 1e-4f;
+  parsed[1].gx = -1.0f;
+  const size_t clamped = parseMpu6886Fifo(burst, sizeof(burst), parsed, 1);
+  const bool parseOk = scaleOk && whole == 3 && clamped == 1 && parsed[1].gx == -1.0f &&
+                       parseMpu6886Fifo(burst, kMpu6886FifoFrameBytes - 1, parsed, 4) == 0;
+
+  // DC: every filtered output equals the input. Ramp: the linear-phase FIR lags by 3.5 inputs.
+  // Warm-up (fewer than kTaps inputs) passes the newest frame through unfiltered.
+  ImuDecimator decimator;
+  float dcErr = 0.0f;
+  float rampErr = 0.0f;
+  size_t outputs = 0;
+  bool cadenceOk = true;
+  bool warmupOk = true;
+  for (int pass = 0; pass < 2; ++pass) {
+    decimator.reset();
+    for (size_t i = 0; i < 400; ++i) {
+      ImuSample in;
+      in.gx = 37.5f;
+      in.gy = static_cast<float>(i);
+      in.az = (i % 2 == 0) ? 1.0f : 0.5f;  // Nyquist-rate tone on top of 0.75 g
+      in.tempC = 30.0f + 0.01f * i;
+      ImuSample out;
+      const bool emitted = decimator.push(in, out);
+      cadenceOk = cadenceOk && emitted == (i % ImuDecimator::kFactor == ImuDecimator::kFactor - 1);
+      if (!emitted) {
+        continue;
+      }
+      ++outputs;
+      cadenceOk = cadenceOk && out.tempC == in.tempC;
+      if (i + 1 < ImuDecimator::kTaps) {
+        warmupOk = warmupOk && out.gy == in.gy && out.az == in.az;
+        continue;
+      }
+      dcErr = fmaxf(dcErr, fmaxf(fabsf(out.gx - 37.5f), fabsf(out.az - 0.75f)));
+      rampErr = fmaxf(rampErr, fabsf(out.gy - (static_cast<float>(i) - 3.5f)));
+    }
+  }
+  const bool ok = parseOk && outputs == 200 && cadenceOk && warmupOk && dcErr < 2e-4f && rampErr < 2e-3f;
+  printf("\nimu fifo: parse(scale+order=%s frames=%zu clamp=%zu) decimator(outputs=%zu cadence=%s warmup=%s "
+         "dc_err=%.1e ramp_delay_err=%.1e) -> %s\n",
+         scaleOk ? "ok" : "bad", whole, clamped, outputs, cadenceOk ? "ok" : "bad", warmupOk ? "ok" : "bad", dcErr,
+         rampErr, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// Rigid-body reference for the orientation checks: body-to-world quaternion, same convention
+// as OrientationFilter.
+struct Quat {
+  double w;
+  double x;
+  double y;
+  double z;
+};
+
+Quat quatMul(const Quat& a, const Quat& b) {
+  Quat q;
+  q.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+  q.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+  q.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+  q.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+  return q;
+}
+
+Quat quatAxisAngle(double ax, double ay, double az, double angleRad) {
+  const double n = std::sqrt(ax * ax + ay * ay + az * az);
+  const double s = (n > 0.0) ? std::sin(angleRad * 0.5) / n : 0.0;
+  Quat q;
+  q.w = std::cos(angleRad * 0.5);
+  q.x = ax * s;
+  q.y = ay * s;
+  q.z = az * s;
+  return q;
+}
+
+// World vector expressed in the body frame (R^T v).
+void toBody(const Quat& q, const double v[3], double out[3]) {
+  const Quat vq = {0.0, v[0], v[1], v[2]};
+  const Quat conj = {q.w, -q.x, -q.y, -q.z};
+  const Quat r = quatMul(quatMul(conj, vq), q);
+  out[0] = r.x;
+  out[1] = r.y;
+  out[2] = r.z;
+}
+
+double angleDeg(const double a[3], float bx, float by, float bz) {
+  const double dot = a[0] * bx + a[1] * by + a[2] * bz;
+  const double nb = std::sqrt(static_cast<double>(bx) * bx + static_cast<double>(by) * by + static_cast<double>(bz) * bz);
+  const double c = dot / nb;
+  return std::acos(c > 1.0 ? 1.0 : (c < -1.0 ? -1.0 : c)) * 57.29577951;
+}
+
+// Drives the filter at 1 kHz with a body turning at world rate `rateDps(t)` while the hand adds
+// linear acceleration `accelG(t)` (world frame); the gyro carries a constant bias. Returns the
+// largest up-vector error after `settleS`.
+template <typename Rate, typename Accel>
+double orientationError(Quat truth, double seconds, double settleS, float biasDps, Rate rateDps, Accel accelG) {
+  constexpr double kDt = 0.001;
+  constexpr double kRad = 0.01745329252;
+  OrientationFilter filter;
+  double worst = 0.0;
+  const double up[3] = {0.0, 0.0, 1.0};
+  for (int i = 0; i < static_cast<int>(seconds / kDt); ++i) {
+    const double t = i * kDt;
+    double wWorld[3];
+    rateDps(t, wWorld);
+    double wBody[3];
+    toBody(truth, wWorld, wBody);
+    double aWorld[3];
+    accelG(t, aWorld);
+    aWorld[2] += 1.0;  // At rest the accelerometer reads +1 g along world up
+    double aBody[3];
+    toBody(truth, aWorld, aBody);
+    ImuSample sample;
+    sample.gx = static_cast<float>(wBody[0]) + biasDps;
+    sample.gy = static_cast<float>(wBody[1]) - biasDps;
+    sample.gz = static_cast<float>(wBody[2]) + biasDps;
+    sample.ax = static_cast<float>(aBody[0]);
+    sample.ay = static_cast<float>(aBody[1]);
+    sample.az = static_cast<float>(aBody[2]);
+    filter.update(sample, static_cast<float>(kDt));
+    // World-frame rate: rotate on the left.
+    const double rate = std::sqrt(wWorld[0] * wWorld[0] + wWorld[1] * wWorld[1] + wWorld[2] * wWorld[2]);
+    if (rate > 0.0) {
+      truth = quatMul(quatAxisAngle(wWorld[0], wWorld[1], wWorld[2], rate * kRad * kDt), truth);
+    }
+    if (t < settleS) {
+      continue;
+    }
+    double upBody[3];
+    toBody(truth, up, upBody);
+    float ux = 0.0f;
+    float uy = 0.0f;
+    float uz = 0.0f;
+    filter.upVector(ux, uy, uz);
+    worst = std::fmax(worst, angleDeg(upBody, ux, uy, uz));
+  }
+  return worst;
+}
+
+// Orientation filter against synthetic rotations: tilt tracking while the stick sweeps and
+// tilts with a biased gyro, roll invariance of pointingRates() across grip angles, and the
+// accel gate holding the tilt through hand flicks well past 1 g.
+bool checkOrientation() {
+  constexpr double kPi = 3.14159265358979;
+  // Held 20 deg nose-up and rolled 35 deg in the grip.
+  const Quat held = quatMul(quatAxisAngle(1.0, 0.0, 0.0, 20.0 * kPi / 180.0), quatAxisAngle(0.0, 1.0, 0.0, 35.0 * kPi / 180.0));
+
+  const double sweepErr = orientationError(held, 20.0, 2.0, 0.5f,
+      [](double t, double w[3]) {
+        w[0] = 40.0 * std::sin(2.0 * kPi * 0.3 * t);   // Nodding about world X
+        w[1] = 25.0 * std::sin(2.0 * kPi * 0.17 * t);  // Rolling
+        w[2] = 120.0 * std::sin(2.0 * kPi * 0.5 * t);  // Sweeping left/right
+      },
+      [](double, double a[3]) { a[0] = a[1] = a[2] = 0.0; });
+
+  // 100 ms flicks peaking at 2 g along world X, alternating direction, four per second.
+  const auto flick = [](double t, double a[3]) {
+    const double phase = std::fmod(t, 0.25);
+    const double sign = (std::fmod(t, 0.5) < 0.25) ? 1.0 : -1.0;
+    const double shape = (phase < 0.1) ? std::sin(kPi * phase / 0.1) : 0.0;
+    a[0] = sign * 2.0 * shape * shape;
+    a[1] = 0.0;
+    a[2] = 0.0;
+  };
+  const auto still = [](double, double w[3]) { w[0] = w[1] = w[2] = 0.0; };
+  const double flickErr = orientationError(held, 10.0, 0.0, 0.0f, still, flick);
+  // What accel-only tilt would read at the flick peak.
+  const double accelOnlyDeg = std::atan(2.0) * 57.29577951;
+
+  // Same world motion (50 dps yaw, 30 dps pitch) at every grip roll and a few elevations: the
+  // pointing rates must not change.
+  double rollSpread = 0.0;
+  for (double elevationDeg = -30.0; elevationDeg <= 45.0; elevationDeg += 25.0) {
+    const double el = elevationDeg * kPi / 180.0;
+    for (double rollDeg = 0.0; rollDeg < 360.0; rollDeg += 15.0) {
+      const Quat q = quatMul(quatAxisAngle(1.0, 0.0, 0.0, el), quatAxisAngle(0.0, 1.0, 0.0, rollDeg * kPi / 180.0));
+      const double up[3] = {0.0, 0.0, 1.0};
+      const double wWorld[3] = {30.0, 0.0, 50.0};  // Pitch axis is world X for a stick facing world +Y
+      double upBody[3];
+      double wBody[3];
+      toBody(q, up, upBody);
+      toBody(q, wWorld, wBody);
+      float yaw = 0.0f;
+      float pitch = 0.0f;
+      pointingRates(static_cast<float>(upBody[0]), static_cast<float>(upBody[1]), static_cast<float>(upBody[2]),
+                    static_cast<float>(wBody[0]), static_cast<float>(wBody[1]), static_cast<float>(wBody[2]), yaw,
+                    pitch);
+      rollSpread = std::fmax(rollSpread, std::fmax(std::fabs(yaw - 50.0), std::fabs(pitch - 30.0)));
+    }
+  }
+
+  const bool ok = sweepErr < 1.5 && flickErr < 1.5 && rollSpread < 0.01;
+  printf("\norientation: sweep_tilt_err=%.2f deg (biased gyro), flick_tilt_err=%.2f deg (accel-only would be %.0f), "
+         "pointing_roll_err=%.4f dps -> %s\n",
+         sweepErr, flickErr, accelOnlyDeg, rollSpread, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// Bias-vs-temperature model on a warm-up ramp with noise: interpolation inside the learned
+// range, slope extrapolation outside it, the slope clamp, and restore() rejecting bad state.
+bool checkTempBiasModel() {
+  const float kTrueSlope[3] = {0.05f, -0.08f, 0.12f};
+  const float kTrueAt30[3] = {1.2f, -0.6f, 0.3f};
+  const auto trueBias = [&](float tempC, size_t axis) { return kTrueAt30[axis] + kTrueSlope[axis] * (tempC - 30.0f); };
+
+  // Still windows every 0.03 C from 19 C to 46 C: whole bins 3..11, centres 20.5..44.5 C.
+  uint32_t seed = 4242;
+  TempBiasModel model;
+  for (float t = 19.0f; t < 46.0f; t += 0.03f) {
+    float b[3];
+    for (size_t a = 0; a < 3; ++a) {
+      b[a] = trueBias(t, a) + uniform(seed, -0.03f, 0.03f);
+    }
+    model.observe(t, b[0], b[1], b[2]);
+  }
+  const auto maxError = [&](const TempBiasModel& m, float fromC, float toC) {
+    float worst = 0.0f;
+    for (float t = fromC; t <= toC; t += 0.1f) {
+      float b[3];
+      m.predict(t, b[0], b[1], b[2]);
+      for (size_t a = 0; a < 3; ++a) {
+        worst = fmaxf(worst, fabsf(b[a] - trueBias(t, a)));
+      }
+    }
+    return worst;
+  };
+  const float insideErr = maxError(model, 20.5f, 44.5f);
+  // Below the first and above the last bin centre, out to the table ends (11.5 and 56.5 C).
+  const float outsideErr = fmaxf(maxError(model, 11.5f, 20.5f), maxError(model, 44.5f, 56.5f));
+  float slopeErr = 0.0f;
+  for (size_t a = 0; a < 3; ++a) {
+    slopeErr = fmaxf(slopeErr, fabsf(model.slopeDpsPerC(a) - kTrueSlope[a]));
+  }
+
+  // Steeper than the sensor can be: the fitted slope is clamped, so predictions beyond the
+  // learned range grow at the clamp while those inside still follow the data.
+  TempBiasModel steep;
+  for (float t = 25.0f; t < 37.0f; t += 0.05f) {
+    steep.observe(t, 0.6f * (t - 30.0f), -0.6f * (t - 30.0f), 0.0f);
+  }
+  float lo[3];
+  float hi[3];
+  steep.predict(50.0f, lo[0], lo[1], lo[2]);
+  steep.predict(56.0f, hi[0], hi[1], hi[2]);
+  const float clamp = TempBiasModel::kMaxSlopeDpsPerC;
+  const bool clampOk = steep.slopeDpsPerC(0) == clamp && steep.slopeDpsPerC(1) == -clamp &&
+                       fabsf((hi[0] - lo[0]) / 6.0f - clamp) < 1e-4f && fabsf((hi[1] - lo[1]) / 6.0f + clamp) < 1e-4f;
+
+  // restore(): a good state round-trips; a version or NaN mismatch is rejected untouched.
+  const TempBiasModel::State good = model.state();
+  TempBiasModel restored;
+  bool restoreOk = restored.restore(good) && maxError(restored, 11.5f, 56.5f) == maxError(model, 11.5f, 56.5f);
+  TempBiasModel::State bad = good;
+  bad.version = TempBiasModel::kStateVersion + 1;
+  TempBiasModel rejected;
+  restoreOk = restoreOk && !rejected.restore(bad);
+  bad = good;
+  bad.bias[5][1] = NAN;
+  restoreOk = restoreOk && !rejected.restore(bad);
+  bad = good;
+  bad.weight[7] = NAN;
+  restoreOk = restoreOk && !rejected.restore(bad) && !rejected.ready();
+
+  const bool ok = insideErr < 0.03f && outsideErr < 0.04f && slopeErr < 0.002f && clampOk && restoreOk;
+  printf("\ntemp bias model: inside_err=%.4f outside_err=%.4f slope_err=%.4f dps/C bins=%zu clamp=%s restore=%s -> %s\n",
+         insideErr, outsideErr, slopeErr, model.learnedBins(), clampOk ? "ok" : "bad", restoreOk ? "ok" : "bad",
+         ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// Synthetic presses and releases 40-300 ms apart, each starting a burst of up to 12 bounce
+// edges within 3 ms. 2% of interrupts are lost, short glitches read back the idle level, and a
+// 1 ms poll calls settle(). Every transition must come out exactly once and in order; a lost
+// first edge shows up as timestamp error.
+bool checkButtonDebouncer() {
+  struct RawEdge {
+    uint32_t timeUs;
+    bool level;
+    bool delivered;
+  };
+  uint32_t seed = 777;
+  std::vector<RawEdge> edges;
+  std::vector<uint32_t> transitions;
+  uint32_t t = 10000;
+  bool level = false;
+  for (int i = 0; i < 4000; ++i) {
+    t += static_cast<uint32_t>(uniform(seed, 40000.0f, 300000.0f));
+    level = !level;
+    transitions.push_back(t);
+    const int bounces = 2 * static_cast<int>(uniform(seed, 0.0f, 6.99f));  // Even: ends at `level`
+    uint32_t edgeUs = t;
+    bool edgeLevel = level;
+    edges.push_back({edgeUs, edgeLevel, uniform(seed, 0.0f, 1.0f) > 0.02f});
+    for (int b = 0; b < bounces; ++b) {
+      edgeUs += static_cast<uint32_t>(uniform(seed, 20.0f, 3000.0f / bounces));
+      edgeLevel = !edgeLevel;
+      edges.push_back({edgeUs, edgeLevel, uniform(seed, 0.0f, 1.0f) > 0.02f});
+    }
+  }
+
+  ButtonDebouncer debouncer;
+  debouncer.reset(false, 0);
+  size_t next = 0;
+  bool line = false;
+  size_t reported = 0;
+  bool orderOk = true;
+  uint32_t maxErrUs = 0;
+  size_t late = 0;
+  size_t glitches = 0;
+  auto report = [&](bool pressed, uint32_t timeUs) {
+    if (reported >= transitions.size() || pressed != (reported % 2 == 0)) {
+      orderOk = false;
+      return;
+    }
+    const uint32_t errUs = timeUs - transitions[reported];
+    maxErrUs = (errUs > maxErrUs) ? errUs : maxErrUs;
+    late += (errUs > 0) ? 1 : 0;
+    ++reported;
+  };
+  const auto start = std::chrono::steady_clock::now();
+  for (uint32_t pollUs = 1000; pollUs < t + 20000; pollUs += 1000) {
+    for (; next < edges.size() && edges[next].timeUs < pollUs; ++next) {
+      line = edges[next].level;
+      if (edges[next].delivered && debouncer.edge(line, edges[next].timeUs)) {
+        report(line, edges[next].timeUs);
+      }
+    }
+    if (uniform(seed, 0.0f, 1.0f) < 0.005f) {
+      ++glitches;
+      if (debouncer.edge(line, pollUs)) {
+        report(line, pollUs);
+      }
+    }
+    if (debouncer.settle(line, pollUs)) {
+      report(line, debouncer.changedUs());
+    }
+  }
+  const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  const bool ok = orderOk && reported == transitions.size() && maxErrUs <= ButtonDebouncer::kDefaultLockoutUs;
+  printf("\nbutton debounce: %zu transitions, %zu raw edges, %zu glitches -> reported=%zu late=%zu max_err_us=%lu "
+         "ignored=%lu (%.0f ns/poll) -> %s\n",
+         transitions.size(), edges.size(), glitches, reported, late, static_cast<unsigned long>(maxErrUs),
+         static_cast<unsigned long>(debouncer.ignored()), ns / (t / 1000.0), ok ? "ok" : "FAIL");
+  return ok;
+}
+
+struct StageResult {
+  const char* name;
+  double nsPerSample;
+  size_t allocations;
+};
+
+template <typename Fn>
+StageResult runStage(const char* name, const std::vector<MotionInput>& trace, Fn fn) {
+  const size_t allocBefore = g_allocations;
+  const auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < kRepeats; ++r) {
+    for (const MotionInput& in : trace) {
+      fn(in);
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  StageResult result;
+  result.name = name;
+  result.nsPerSample = ns / (static_cast<double>(trace.size()) * kRepeats);
+  result.allocations = g_allocations - allocBefore;
+  return result;
+}
+}  // namespace
+
+void* operator new(size_t size) {
+  ++g_allocations;
+  void* p = std::malloc(size ? size : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+int main(int argc, char** argv) {
+  const std::vector<MotionInput> trace = makeTrace();
+  volatile float sink = 0.0f;
+  MotionPipeline pipeline;
+  const MotionPipeline::Config& config = pipeline.config();
+
+  StageResult results[10];
+  results[0] = runStage("deadzone", trace, [&](const MotionInput& in) {
+    sink = MotionPipeline::deadzone(in.gx, config.deadzoneDps) + MotionPipeline::deadzone(in.gy, config.deadzoneDps) +
+           MotionPipeline::deadzone(in.gz, config.deadzoneDps);
+  });
+  results[1] = runStage("rest_lock", trace, [&](const MotionInput& in) {
+    sink = pipeline.updateRestLock(in, in.gx, in.gy, in.gz) ? 1.0f : 0.0f;
+  });
+  results[2] = runStage("accel_curve", trace, [&](const MotionInput& in) {
+    sink = in.profile->gainAt(fastHypot(in.gz, in.gx));
+  });
+  results[3] = runStage("filter", trace, [&](const MotionInput& in) {
+    pipeline.filter(in.gz * in.profile->sensitivityX * in.dt, in.gx * in.profile->sensitivityY * in.dt, fabsf(in.gz),
+                    in.dt);
+  });
+  PointerDelta delta;
+  results[4] = runStage("quantize", trace, [&](const MotionInput& in) {
+    pipeline.filter(in.gz * in.profile->sensitivityX * in.dt, in.gx * in.profile->sensitivityY * in.dt, fabsf(in.gz),
+                    in.dt);
+    sink = pipeline.quantize(delta) ? delta.x : 0.0f;
+  });
+  pipeline.reset();
+  long totalX = 0;
+  long reports = 0;
+  results[5] = runStage("pipeline", trace, [&](const MotionInput& in) {
+    if (pipeline.process(in, delta)) {
+      totalX += delta.x;
+      ++reports;
+    }
+  });
+  // The libm versions these stages used before FastMath, for comparison.
+  results[6] = runStage("accel_libm", trace, [&](const MotionInput& in) {
+    const BallisticsReference& ref = kBallisticsReference[0];
+    float norm = sqrtf(in.gz * in.gz + in.gx * in.gx) / ref.refDps;
+    norm = (norm > 1.0f) ? 1.0f : norm;
+    sink = 1.0f + ref.curveGain * powf(norm, ref.exponent);
+  });
+  results[7] = runStage("round_libm", trace, [&](const MotionInput& in) {
+    sink = static_cast<float>(lroundf(in.gz * 0.37f) + lroundf(in.gx * 0.37f));
+  });
+  // Runs on every 1 kHz FIFO frame on the device, i.e. four times per row above.
+  OrientationFilter orientation;
+  results[8] = runStage("orientation", trace, [&](const MotionInput& in) {
+    ImuSample frame;
+    frame.gx = in.gx;
+    frame.gy = in.gy;
+    frame.gz = in.gz;
+    frame.ax = in.ax;
+    frame.ay = in.ay;
+    frame.az = in.az;
+    orientation.update(frame, 0.001f);
+    sink = orientation.q0();
+  });
+  results[9] = runStage("pointing", trace, [&](const MotionInput& in) {
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+    pointingRates(in.upX, in.upY, in.upZ, in.gx, in.gy, in.gz, yaw, pitch);
+    sink = yaw + pitch;
+  });
+  (void)sink;
+
+  printf("MotionPipeline bench: %zu samples x %d repeats\n", trace.size(), kRepeats);
+  printf("%-12s %12s %8s\n", "stage", "ns/sample", "allocs");
+  for (const StageResult& r : results) {
+    printf("%-12s %12.2f %8zu\n", r.name, r.nsPerSample, r.allocations);
+  }
+  printf("note: quantize includes one filter step; *_libm rows are the pre-table versions; orientation is one "
+         "1 kHz frame\n");
+  printf("pipeline output: %ld reports, net x=%ld\n", reports, totalX);
+
+  printf("\nfilter lag/jitter (rise = 10-90%%, lower is better)\n");
+  printf("%-12s %10s %10s %10s %10s\n", "filter", "rise150_ms", "rise10_ms", "ramp_ms", "hold_rms");
+  printFilterScore("ema_0.12", scoreFilter<EmaReference>());
+  printFilterScore("one_euro", scoreFilter<OneEuroAxis>());
+
+  const bool fastMathOk = checkFastMath();
+  const bool imuFifoOk = checkImuFifo();
+  const bool orientationOk = checkOrientation();
+  const bool tempBiasOk = checkTempBiasModel();
+  const bool debounceOk = checkButtonDebouncer();
+
+  printPredictorScores("synthetic", makeSyntheticRates());
+  const GestureTrace gestures = makeGestureTrace();
+  printGestureScores("synthetic", gestures.rates, gestures.labels);
+  if (argc > 1) {
+    RateTrace recorded;
+    if (!loadRecordedRates(argv[1], recorded)) {
+      printf("could not read a usable imu.csv from %s\n", argv[1]);
+      return 1;
+    }
+    printPredictorScores(argv[1], recorded);
+    if (argc > 2) {
+      std::vector<GestureLabel> labels;
+      if (!loadGestureLabels(argv[2], labels)) {
+        printf("could not read gesture labels from %s\n", argv[2]);
+        return 1;
+      }
+      printGestureScores(argv[1], recorded, labels);
+    }
+  }
+  return (fastMathOk && imuFifoOk && orientationOk && tempBiasOk && debounceOk) ? 0 : 1;
+}
@@ -1,17 +1,48 @@
 #include <Arduino.h>
 #include <M5Unified.h>
 #include <BleMouse.h>
+#include <Preferences.h>
+#include <esp_heap_caps.h>
+#include <stdarg.h>
+#include <atomic>
+
+#include <BallisticsProfile.h>
+#include <GestureRecognizer.h>
+#include <GyroBiasEstimator.h>
+#include <LatencyHistogram.h>
+#include <MotionPipeline.h>
+#include <OrientationFilter.h>
+#include <TempBiasModel.h>
+
+#include "ButtonCapture.h"
+#include "Mpu6886Fifo.h"
+#include "SpscRing.h"
+#include "StageProfiler.h"
+#include "TelemetryStream.h"
 
 namespace {
 constexpr const char* kDeviceName = "IMUPointer";
 constexpr const char* kManufacturer = "M5Stack";
 
-constexpr uint32_t kSampleIntervalMs = 4;     // ~250 Hz IMU sampling (BLE report rate still host-limited)
-constexpr float kSensitivityX = 46.0f;        // Left/right (yaw) multiplier
-constexpr float kSensitivityY = 38.0f;        // Up/down (pitch) multiplier
-constexpr float kScrollSensitivity = 0.85f;   // Scroll speed when BtnB in scroll mode
+constexpr uint32_t kSampleIntervalMs = 4;     // ~250 Hz motion rate (BLE report rate still host-limited)
+constexpr float kFifoFrameDt = 1.0f / Mpu6886Fifo::kOdrHz;
+constexpr float kDecimatedSampleDt = static_cast<float>(ImuDecimator::kFactor) / Mpu6886Fifo::kOdrHz;
+constexpr uint32_t kIdleOdrHz = 100;          // Sensor rate while rest-locked or in the menu
+constexpr uint32_t kIdleSampleIntervalMs = 10; // One FIFO frame per motion-task wake while idle
+constexpr uint32_t kIdleEnterMs = 1000;       // Quiet this long (on top of the rest lock) before idling
+constexpr float kMotionWakeChargeUc = 6.0f;   // Est. per motion-task wake: I2C burst + pipeline at 240 MHz
+constexpr float kRadioEventChargeUc = 45.0f;  // Est. per attended connection event: RX window + TX
+constexpr float kScrollSensitivity = 0.85f;   // Scroll speed when BtnB in scroll mode (detents)
+// 16-bit X/Y + hi-res wheel; false = legacy 8-bit report. Build-time only: bonded hosts cache
+// the report map, so switching it needs a re-pair, not just a re-advertise.
+constexpr bool kHighResReports = true;
+constexpr bool kTelemetryBinary = false;      // COBS binary records instead of text debug output
+constexpr uint32_t kTelemetryBaud = 921600;
+constexpr size_t kTelemetryTxBufferBytes = 4096;
 constexpr float kDeadzoneDps = 1.20f;         // Ignore tiny gyro drift
-constexpr float kFilterAlpha = 0.12f;         // 0..1 low-pass blend factor (lower = smoother)
+constexpr float kFilterMinCutoffHz = 3.0f;    // Smoothing while aiming (lower = steadier)
+constexpr float kFilterBetaHzPerDps = 0.20f;  // Cutoff rise with speed (higher = less lag on sweeps)
+constexpr bool kGesturesDefaultOn = false;    // Flick/circle gestures until toggled in the menu
 constexpr float kRestGyroDps = 3.20f;         // Near-still threshold for desk-rest lock
 constexpr uint32_t kRestEnterMs = 360;        // How long to be still before rest lock
 constexpr float kFlatAccelZMin = 0.90f;       // "Face-up/face-down on desk" accel check
@@ -21,12 +52,25 @@ constexpr float kRestWakeGyroEarlyDps = 2.7f;
 constexpr float kRestWakeGyroLateDps = 8.8f;
 constexpr float kRestPickupTiltG = 0.42f;     // Pick-up detection based on tilt away from flat
 constexpr float kRestPickupZMinG = 0.75f;
-constexpr float kAccelCurveGain = 0.28f;      // Light speed-up for faster motions
-constexpr float kAccelCurveRefDps = 120.0f;
-constexpr uint16_t kCalibSamples = 320;       // Startup gyro calibration
+constexpr uint16_t kCalibSamples = 320;       // Full gyro calibration (first boot / manual)
+constexpr uint8_t kCalibCountdownS = 3;       // Manual recalibration: "Keep still" countdown
+constexpr uint32_t kCalibTimeoutMs = 3000;    // Give up if the motion task stops delivering samples
+constexpr uint32_t kCalibDoneHoldMs = 180;    // Overlay stays up this long after the result
+constexpr uint16_t kBootCheckSamples = 64;    // ~256 ms still window to validate the stored bias
+constexpr uint32_t kBootCheckTimeoutMs = 4000;
+constexpr float kBootCheckMaxStdDps = 0.35f;
+constexpr float kBootBiasToleranceDps = 0.60f;
+constexpr uint32_t kBiasSaveIntervalMs = 300000;  // Limit background NVS writes to one per 5 min
+constexpr float kBiasSaveDeltaDps = 0.05f;
+constexpr float kCalibrationModelWeight = 64.0f;  // A full calibration overwrites its temperature bin
+constexpr uint32_t kPollTempIntervalMs = 1000;    // Die temperature refresh when the FIFO is unavailable
 constexpr uint32_t kRecalibHoldMs = 1500;     // Hold A+B to recalibrate
 constexpr uint32_t kPairingHoldMs = 1200;     // Hold B (in menu) to force pairing mode
+constexpr uint32_t kStatsHoldMs = 1000;       // Hold A (in menu) to toggle the latency page
+constexpr uint32_t kSettingsSaveDelayMs = 2000; // Store menu settings once the choice settles
+constexpr uint32_t kRestWakeLatencyMs = 500;  // Reports this soon after a rest-lock release are tagged
 constexpr uint32_t kStatusRefreshMs = 240;
+constexpr uint32_t kLoopStatsPublishMs = 100; // Loop task refreshes the stats the UI task shows
 constexpr uint32_t kBatteryRefreshMs = 1500;
 constexpr uint32_t kDebugRefreshMs = 1000;
 constexpr uint32_t kClickStabilizeMs = 140;   // Freeze movement right after left-click press
@@ -34,6 +78,27 @@ constexpr float kClickSensitivityScale = 0.30f;
 constexpr float kClickDeadzoneDps = 2.80f;
 constexpr uint8_t kDisplayRotation = 2;       // 90 degrees clockwise from previous layout
 
+// The motion task shares core 1 with the HID loop, which it preempts: core 0 already runs the
+// NimBLE host and controller tasks beside the UI and display, and a 250 Hz task above them there
+// would delay connection events instead of our own button and report work.
+constexpr BaseType_t kMotionTaskCore = 1;
+constexpr UBaseType_t kMotionTaskPriority = configMAX_PRIORITIES - 2;
+constexpr uint32_t kMotionTaskStack = 4096;
+constexpr BaseType_t kUiTaskCore = 0;         // Display, battery and serial debug work
+constexpr UBaseType_t kUiTaskPriority = 1;
+constexpr uint32_t kUiTaskStack = 6144;
+constexpr uint32_t kUiTaskPeriodMs = 10;
+constexpr UBaseType_t kDisplayTaskPriority = 1;  // Same core as the UI task; owns the panel
+constexpr uint32_t kDisplayTaskStack = 6144;
+constexpr size_t kDisplayQueueDepth = 4;
+constexpr uint32_t kDisplayPostWaitMs = 20;
+constexpr size_t kDisplayBandRows = 16;       // Rows per DMA band buffer (two are allocated)
+constexpr size_t kMaxPanelRows = 320;
+constexpr size_t kMotionQueueDepth = 32;      // Motion deltas waiting for the HID loop
+constexpr size_t kGestureQueueDepth = 4;      // Recognized gestures waiting for the HID loop
+constexpr uint32_t kLateSampleSlackUs = 1000; // Periods longer than interval + slack count as late
+constexpr uint32_t kFusionCycleBudget = 4800;  // 20 us at 240 MHz per orientation update
+
 constexpr uint16_t kBgTop = 0x018A;           // Deep teal-blue
 constexpr uint16_t kBgBottom = 0x0843;        // Very dark blue-gray
 constexpr uint16_t kPanel = 0x10A2;           // Dark slate
@@ -57,50 +122,331 @@ enum class BtnBMode : uint8_t {
   Scroll,
 };
 
+enum class GestureAction : uint8_t {
+  None,
+  LeftClick,
+  RightClick,
+  MiddleClick,
+  Back,
+  Forward,
+  WheelUp,    // One detent
+  WheelDown,
+  PageUp,     // Keyboard report
+  PageDown,
+  LaserPointer,  // Ctrl+L: PowerPoint's laser pointer toggle
+  Blackout,      // B: blank the screen in PowerPoint and Keynote
+  VolumeUp,      // Consumer-control report
+  VolumeDown,
+  PlayPause,
+};
+
+// What each gesture sends, indexed by Gesture. Page Up/Down change slides in PowerPoint,
+// Keynote, Google Slides and PDF viewers.
+constexpr GestureAction kGestureActions[kGestureCount] = {
+  GestureAction::None,          // None
+  GestureAction::PageUp,        // FlickLeft: previous slide
+  GestureAction::PageDown,      // FlickRight: next slide
+  GestureAction::LaserPointer,  // Circle
+};
+
+struct GestureEvent {
+  Gesture gesture;
+  float score;  // Relative DTW cost, lower is a closer match
+};
+
+struct MotionDelta {
+  int16_t x;
+  int16_t y;
+  int16_t wheel;     // 1/MOUSE_WHEEL_RESOLUTION detents
+  uint8_t context;   // LatencyContext bits at sampling time
+  uint32_t sampleUs; // micros() when the newest IMU frame behind this delta was acquired
+};
+
+// Conditions a latency sample is additionally filed under.
+enum LatencyContext : uint8_t {
+  kLatencyDisplayBusy = 0x01,  // Display task was rendering or pushing rows
+  kLatencyRestWake = 0x02,     // Shortly after the rest lock released
+  kLatencyClickHeld = 0x04,    // Left button held (click stabilization / drag)
+};
+
+constexpr size_t kLatencyContextCount = 3;
+
+// Sampling and link power level, chosen by the motion task from the rest lock and UI mode.
+enum class PowerState : uint8_t {
+  Active,  // 1 kHz FIFO, 250 Hz pipeline, fast connection interval
+  Idle,    // 100 Hz FIFO fed straight to the pipeline, long interval with peripheral latency
+};
+
+struct SampleJitterStats {
+  uint32_t count = 0;
+  uint32_t minUs = UINT32_MAX;
+  uint32_t maxUs = 0;
+  uint64_t sumUs = 0;
+  uint64_t sumAbsDevUs = 0;
+  uint32_t late = 0;
+  uint32_t fusionUpdates = 0;
+  uint64_t fusionCyclesSum = 0;
+  uint32_t fusionCyclesMax = 0;
+  uint32_t fusionOverBudget = 0;
+};
+
+// Captured button edge to the bleMouse press/release call, per debug period.
+struct ClickLatencyStats {
+  uint32_t edges = 0;
+  uint64_t sumUs = 0;
+  uint32_t maxUs = 0;
+};
+
 struct GyroBias {
   float x = 0.0f;
   float y = 0.0f;
   float z = 0.0f;
 };
 
+enum class CalibrationSource : uint8_t {
+  Full,
+  BootCheck,
+  Background,
+};
+
+// Stored in NVS so the device can point straight away on the next power-on.
+struct CalibrationRecord {
+  uint32_t magic;
+  uint16_t version;
+  uint8_t source;
+  uint8_t reserved;
+  float biasX;
+  float biasY;
+  float biasZ;
+  float tempC;
+  uint32_t samples;
+  uint32_t saveCount;
+};
+
+constexpr uint32_t kCalibrationMagic = 0x434D4949;  // "IIMC"
+constexpr uint16_t kCalibrationVersion = 1;
+
+// Bonded hosts by slot; the bonds themselves live in NimBLE's own NVS store.
+struct HostSlotsRecord {
+  uint8_t selected;
+  BleMouseHost hosts[BLE_MOUSE_HOST_SLOTS];
+};
+constexpr const char* kPrefsNamespace = "imupointer";
+constexpr const char* kPrefsCalibrationKey = "calib";
+constexpr const char* kPrefsTempBiasKey = "tbias";
+constexpr const char* kPrefsProfileKey = "profile";
+constexpr const char* kPrefsGesturesKey = "gestures";
+constexpr const char* kPrefsHostsKey = "hosts";
+
+enum class BootPhase : uint8_t {
+  HardwareReady,
+  BleAdvertising,
+  CalibrationLoaded,
+  MotionStarted,
+  FirstSample,
+  Connected,
+  FirstReport,
+  Count,
+};
+
+constexpr size_t kBootPhaseCount = static_cast<size_t>(BootPhase::Count);
+
+// Stored-bias check run by the motion task right after boot.
+struct BootBiasCheck {
+  bool active = false;
+  uint32_t startMs = 0;
+  uint16_t count = 0;
+  float sum[3] = {0.0f, 0.0f, 0.0f};
+  float sumSq[3] = {0.0f, 0.0f, 0.0f};
+};
+
+// Boot check outcome: filled in once by the motion task, printed by the UI task so the motion
+// task never waits on the UART.
+struct BootCheckReport {
+  std::atomic<bool> ready{false};
+  bool timedOut = false;
+  bool replaced = false;
+  uint32_t atMs = 0;
+  float measured[3] = {0.0f, 0.0f, 0.0f};
+};
+
+// The pointer is paused in every phase but Off.
+enum class CalibrationPhase : uint8_t {
+  Off,
+  Countdown,  // Loop task ticks the overlay down
+  Sampling,   // Motion task averages kCalibSamples samples
+  Done,       // Motion task has set the bias; the loop task reports it
+  Closing,    // Loop task holds the overlay for kCalibDoneHoldMs
+};
+
+// Handed between the loop and motion tasks through `phase`: the accumulators belong to the
+// motion task while Sampling and to the loop task otherwise.
+struct GyroCalibration {
+  std::atomic<CalibrationPhase> phase{CalibrationPhase::Off};
+  uint32_t phaseStartMs = 0;
+  uint8_t countdownShown = 0;
+  uint16_t samples = 0;
+  float sum[3] = {0.0f, 0.0f, 0.0f};
+  float tempSum = 0.0f;
+};
+
+// Written by the motion task; other tasks read it through biasSnapshot().
 GyroBias g_bias;
-float g_filteredX = 0.0f;
-float g_filteredY = 0.0f;
-float g_accumX = 0.0f;
-float g_accumY = 0.0f;
-float g_accumWheel = 0.0f;
-
-float g_lastGyroX = 0.0f;
-float g_lastGyroY = 0.0f;
-float g_lastGyroZ = 0.0f;
+portMUX_TYPE g_biasMux = portMUX_INITIALIZER_UNLOCKED;
+GyroCalibration g_calibration;
+CalibrationRecord g_savedCalibration = {};
+volatile bool g_calibrationDirty = false;
+CalibrationSource g_calibrationSource = CalibrationSource::Full;
+uint32_t g_lastCalibrationSaveMs = 0;
+float g_lastTempC = 0.0f;
+BootBiasCheck g_bootCheck;
+BootCheckReport g_bootCheckReport;
+uint32_t g_bootPhaseUs[kBootPhaseCount] = {};
+bool g_bootTimelinePrinted = false;
+
+std::atomic<float> g_lastGyroX{0.0f};
+std::atomic<float> g_lastGyroY{0.0f};
+std::atomic<float> g_lastGyroZ{0.0f};
 int g_lastMoveX = 0;
 int g_lastMoveY = 0;
 int g_lastWheel = 0;
 
-UiMode g_mode = UiMode::AirMouse;
-BtnBMode g_btnBMode = BtnBMode::Scroll;
-bool g_trackingEnabled = true;
+// Set by the loop task, read by the motion, UI and display tasks.
+std::atomic<UiMode> g_mode{UiMode::AirMouse};
+std::atomic<BtnBMode> g_btnBMode{BtnBMode::Scroll};
+std::atomic<bool> g_trackingEnabled{true};
 bool g_recalibLatch = false;
 bool g_pairingLatch = false;
-bool g_pairingClickSuppress = false;
-bool g_restLock = false;
 int32_t g_batteryPercent = -1;
 float g_batteryPercentFiltered = -1.0f;
 bool g_batteryCharging = false;
 
-uint32_t g_lastSampleMs = 0;
+uint32_t g_lastSampleUs = 0;
 uint32_t g_lastStatusMs = 0;
 uint32_t g_lastBatteryMs = 0;
 uint32_t g_lastDebugMs = 0;
-uint32_t g_restCandidateMs = 0;
-uint32_t g_restLockSinceMs = 0;
-uint32_t g_leftPressStartMs = 0;
 
 bool g_leftDown = false;
 bool g_rightDown = false;
 bool g_prevConnected = false;
 M5Canvas g_canvas(&M5.Display);
-bool g_canvasReady = false;
+bool g_canvasReady = false;  // false: no RAM for the frame, widgets are drawn onto the panel
+int g_statusW = 0;
+int g_statusH = 0;
+
+// Motion runs in its own task; the HID loop only drains finished deltas.
+SpscRing<MotionDelta, kMotionQueueDepth> g_motionQueue;
+SpscRing<GestureEvent, kGestureQueueDepth> g_gestureQueue;
+volatile bool g_motionResetRequested = false;
+SemaphoreHandle_t g_imuMutex = nullptr;
+Mpu6886Fifo g_imuFifo;
+ImuDecimator g_decimator;
+OrientationFilter g_orientation;
+MotionPipeline g_pipeline;  // Motion task only; rest-lock flag is read by the UI
+GestureRecognizer g_gestures;  // Motion task only
+bool g_gesturesArmed = false;  // Motion task: recognizer has state worth keeping
+volatile bool g_gesturesEnabled = kGesturesDefaultOn;  // Toggled by the loop task
+// Motion-to-notify latency, recorded on the loop task from the BleMouse report observer.
+LatencyHistogram g_latency;
+LatencyHistogram g_latencyByContext[kLatencyContextCount];
+bool g_latencyPending = false;
+uint32_t g_latencySampleUs = 0;
+uint8_t g_latencyContext = 0;
+volatile bool g_displayBusy = false;
+bool g_latencyRestLock = false;
+uint32_t g_restWakeUntilMs = 0;
+std::atomic<bool> g_statsPage{false};  // Written by the loop task, drawn by the UI task
+bool g_statsLatch = false;
+// Ballistics: the loop task publishes the selected profile; the motion task reads the pointer
+// once per sample. Profiles are immutable tables in flash, so a swap is all a switch costs.
+std::atomic<const BallisticsProfile*> g_profile{&kBallisticsProfiles[0]};
+std::atomic<uint8_t> g_profileIndex{0};  // Written by the loop task, drawn by the UI task
+// Feel or gesture toggle changed: set by the loop task, saved by the UI task.
+volatile bool g_settingsDirty = false;
+volatile uint32_t g_settingsChangedMs = 0;
+uint32_t g_savedHostsRevision = 0;  // UI task
+// Binary telemetry, one stream per producer task; both drained by the UI task.
+TelemetryStream g_motionTelemetry;  // IMU frames, pipeline output, rest lock
+TelemetryStream g_hidTelemetry;     // HID reports and UI/connection state
+bool g_telemetryRestLock = false;
+bool g_telemetryConnected = false;
+UiMode g_telemetryMode = UiMode::AirMouse;
+bool g_telemetryTracking = true;
+BtnBMode g_telemetryBtnBMode = BtnBMode::Scroll;
+GyroBiasEstimator g_biasEstimator;
+TempBiasModel g_tempBias;       // Written by the motion task; copied out under g_imuMutex
+TempBiasModel g_savedTempBias;  // UI task copy of what is in NVS
+uint32_t g_lastPollTempMs = 0;
+TaskHandle_t g_motionTask = nullptr;
+TaskHandle_t g_uiTask = nullptr;
+TaskHandle_t g_displayTask = nullptr;
+portMUX_TYPE g_jitterMux = portMUX_INITIALIZER_UNLOCKED;
+SampleJitterStats g_jitter;
+ButtonCapture g_buttons;  // A/B edges for the HID path and the motion task
+portMUX_TYPE g_clickLatencyMux = portMUX_INITIALIZER_UNLOCKED;
+ClickLatencyStats g_clickLatency;
+// Power governor. g_powerState is written by the motion task; the loop task follows it with
+// the BLE link profile so BleMouse keeps a single owner.
+std::atomic<PowerState> g_powerState{PowerState::Active};
+PowerState g_lastTickPowerState = PowerState::Active;  // Motion task: state of the previous tick
+uint32_t g_quietSinceMs = 0;
+uint32_t g_powerStateSinceMs = 0;
+volatile uint32_t g_idleMsTotal = 0;
+volatile uint32_t g_motionWakeups = 0;
+BleMouseLinkProfile g_linkProfile = BleMouseLinkProfile::Fast;  // Loop task: profile last applied
+uint32_t g_linkUpdatesSeen = 0;
+uint32_t g_powerReportMs = 0;
+uint32_t g_powerReportIdleMs = 0;
+uint32_t g_powerReportWakeups = 0;
+
+struct LatencySummary {
+  uint32_t count;
+  uint32_t minUs;
+  uint32_t meanUs;
+  uint32_t p50Us;
+  uint32_t p95Us;
+  uint32_t p99Us;
+  uint32_t maxUs;
+};
+
+// Loop-task state the UI task prints and draws. Only the loop task touches g_latency and
+// BleMouse, so it republishes a copy every kLoopStatsPublishMs and the UI reads that copy.
+struct LoopStats {
+  bool connected;  // Link state the reconnect stats belong to
+  LatencySummary latency;
+  BleMouseReportStats hid;
+  BleMouseLinkStats link;
+  BleMouseReconnectStats reconnect;
+};
+portMUX_TYPE g_loopStatsMux = portMUX_INITIALIZER_UNLOCKED;
+LoopStats g_loopStats = {};
+uint32_t g_loopStatsMs = 0;  // Loop task
+// Battery level from the UI task, handed to BleMouse by the loop task; -1 when nothing is new.
+std::atomic<int16_t> g_pendingBatteryLevel{-1};
+
+constexpr size_t kLogLineBytes = 320;  // Longest debug line ([STATE]) with room to spare
+
+// Every text line goes through here. In binary telemetry mode it is dropped: a byte outside a
+// COBS frame would corrupt the next frame on the host.
+void logPrintf(const char* format, ...) __attribute__((format(printf, 1, 2)));
+void logPrintf(const char* format, ...) {
+  if (kTelemetryBinary) {
+    return;
+  }
+  char line[kLogLineBytes];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if (len <= 0) {
+    return;
+  }
+  if (static_cast<size_t>(len) >= sizeof(line)) {
+    len = sizeof(line) - 1;
+    line[len - 1] = '\n';
+  }
+  Serial.write(reinterpret_cast<const uint8_t*>(line), len);
+}
 
 const char* modeToStr(UiMode mode) {
   return mode == UiMode::Menu ? "menu" : "air";
@@ -114,6 +460,19 @@ const char* btnBModeShort(BtnBMode mode) {
   return mode == BtnBMode::Scroll ? "SCROLL" : "CLICK";
 }
 
+const char* advPhaseToStr(BleMouseAdvPhase phase) {
+  switch (phase) {
+    case BleMouseAdvPhase::Directed:
+      return "directed";
+    case BleMouseAdvPhase::Whitelist:
+      return "whitelist";
+    case BleMouseAdvPhase::Open:
+      return "open";
+    default:
+      return "off";
+  }
+}
+
 uint16_t blend565(uint16_t a, uint16_t b, float t) {
   t = constrain(t, 0.0f, 1.0f);
   const uint8_t ar = (a >> 11) & 0x1F;
@@ -128,25 +487,30 @@ uint16_t blend565(uint16_t a, uint16_t b, float t) {
   return static_cast<uint16_t>((rr << 11) | (rg << 5) | rb);
 }
 
-void drawGradientBackground(M5Canvas& canvas, int w, int h) {
-  for (int y = 0; y < h; ++y) {
-    const float t = static_cast<float>(y) / static_cast<float>(max(1, h - 1));
-    canvas.drawFastHLine(0, y, w, blend565(kBgTop, kBgBottom, t));
+uint16_t backgroundColorAt(int y, int h) {
+  const float t = static_cast<float>(y) / static_cast<float>(max(1, h - 1));
+  return blend565(kBgTop, kBgBottom, t);
+}
+
+// The gradient only varies by row, so any part of it is redrawn from the row colour.
+void drawGradientBackground(lgfx::LGFXBase& canvas, int x, int y, int w, int h, int screenH) {
+  for (int row = y; row < y + h; ++row) {
+    canvas.drawFastHLine(x, row, w, backgroundColorAt(row, screenH));
   }
 }
 
-void drawTag(int x, int y, const char* text, uint16_t fill, uint16_t textColor) {
-  const int w = M5.Display.textWidth(text) + 10;
+void drawTag(lgfx::LGFXBase& canvas, int x, int y, const char* text, uint16_t fill, uint16_t textColor) {
+  const int w = canvas.textWidth(text) + 10;
   const int h = 14;
-  M5.Display.fillRoundRect(x, y, w, h, 4, fill);
-  M5.Display.drawRoundRect(x, y, w, h, 4, blend565(fill, TFT_WHITE, 0.25f));
-  M5.Display.setTextColor(textColor, fill);
-  M5.Display.setTextSize(1);
-  M5.Display.setCursor(x + 5, y + 4);
-  M5.Display.print(text);
+  canvas.fillRoundRect(x, y, w, h, 4, fill);
+  canvas.drawRoundRect(x, y, w, h, 4, blend565(fill, TFT_WHITE, 0.25f));
+  canvas.setTextColor(textColor, fill);
+  canvas.setTextSize(1);
+  canvas.setCursor(x + 5, y + 4);
+  canvas.print(text);
 }
 
-void drawChip(M5Canvas& canvas,
+void drawChip(lgfx::LGFXBase& canvas,
               int x, int y, int w, int h,
               const char* key, const char* value,
               bool on, uint16_t onColor) {
@@ -188,7 +552,7 @@ void updateBatteryState() {
       g_batteryPercentFiltered = 0.75f * g_batteryPercentFiltered + 0.25f * level;
     }
     g_batteryPercent = static_cast<int32_t>(lroundf(g_batteryPercentFiltered));
-    bleMouse.setBatteryLevel(static_cast<uint8_t>(g_batteryPercent));
+    g_pendingBatteryLevel.store(static_cast<int16_t>(g_batteryPercent), std::memory_order_relaxed);
   } else {
     g_batteryPercent = -1;
     g_batteryPercentFiltered = -1.0f;
@@ -197,7 +561,7 @@ void updateBatteryState() {
   g_batteryCharging = (static_cast<int>(M5.Power.isCharging()) == 1);
 }
 
-void drawBatteryBadge(M5Canvas& canvas, int x, int y, int w, int h) {
+void drawBatteryBadge(lgfx::LGFXBase& canvas, int x, int y, int w, int h) {
   uint16_t color = kTextMuted;
   if (g_batteryPercent >= 0) {
     if (g_batteryCharging) {
@@ -245,11 +609,123 @@ void drawBatteryBadge(M5Canvas& canvas, int x, int y, int w, int h) {
   canvas.print(text);
 }
 
-void drawStatusScreen() {
-  const bool connected = bleMouse.isConnected();
-  const bool imuOk = M5.Imu.isEnabled();
-  const int w = M5.Display.width();
-  const int h = M5.Display.height();
+// Retained status screen: each widget remembers the state it was last drawn with and only
+// widgets whose state changed are repainted (over the cached background) and pushed to the panel.
+enum class UiWidget : uint8_t {
+  Header,
+  ModeChip,
+  BtnBChip,
+  TrackChip,
+  RestChip,
+  MainPanel,
+  Battery,
+  Count,
+};
+
+constexpr size_t kUiWidgetCount = static_cast<size_t>(UiWidget::Count);
+
+struct UiRect {
+  int x = 0;
+  int y = 0;
+  int w = 0;
+  int h = 0;
+};
+
+struct UiSnapshot {
+  bool connected;
+  bool imuOk;
+  UiMode mode;
+  BtnBMode btnBMode;
+  bool tracking;
+  bool restLock;
+  int32_t batteryPercent;
+  bool batteryCharging;
+  bool statsPage;
+  uint8_t profileIndex;
+  bool gestures;
+  uint8_t hostSlot;
+  bool hostSaved;
+  BleMouseAdvPhase advPhase;
+  uint32_t latencyCount;
+  uint32_t latencyP50Us;
+  uint32_t latencyP95Us;
+  uint32_t latencyP99Us;
+  uint32_t latencyMaxUs;
+};
+
+UiRect g_widgetRects[kUiWidgetCount];
+uint32_t g_widgetKeys[kUiWidgetCount];
+bool g_uiValid = false;
+
+LoopStats loopStatsSnapshot() {
+  portENTER_CRITICAL(&g_loopStatsMux);
+  const LoopStats stats = g_loopStats;
+  portEXIT_CRITICAL(&g_loopStatsMux);
+  return stats;
+}
+
+UiSnapshot captureUiSnapshot() {
+  UiSnapshot snap;
+  snap.connected = bleMouse.isConnected();
+  snap.imuOk = M5.Imu.isEnabled();
+  snap.mode = g_mode;
+  snap.btnBMode = g_btnBMode;
+  snap.tracking = g_trackingEnabled;
+  snap.restLock = g_pipeline.restLocked();
+  snap.batteryPercent = g_batteryPercent;
+  snap.batteryCharging = g_batteryCharging;
+  snap.statsPage = g_statsPage;
+  snap.profileIndex = g_profileIndex;
+  snap.gestures = g_gesturesEnabled;
+  snap.hostSlot = bleMouse.getHostSlot();
+  snap.hostSaved = bleMouse.hasHost(snap.hostSlot);
+  snap.advPhase = bleMouse.getAdvPhase();
+  const LatencySummary latency = snap.statsPage ? loopStatsSnapshot().latency : LatencySummary();
+  snap.latencyCount = latency.count;
+  snap.latencyP50Us = latency.p50Us;
+  snap.latencyP95Us = latency.p95Us;
+  snap.latencyP99Us = latency.p99Us;
+  snap.latencyMaxUs = latency.maxUs;
+  return snap;
+}
+
+// Packs exactly the state a widget depends on; a changed key means the widget is dirty.
+uint32_t widgetStateKey(UiWidget widget, const UiSnapshot& s) {
+  switch (widget) {
+    case UiWidget::Header:
+      return s.connected ? 1u : 0u;
+    case UiWidget::ModeChip:
+      return static_cast<uint32_t>(s.mode);
+    case UiWidget::BtnBChip:
+      return static_cast<uint32_t>(s.btnBMode);
+    case UiWidget::TrackChip:
+      return s.tracking ? 1u : 0u;
+    case UiWidget::RestChip:
+      return s.restLock ? 1u : 0u;
+    case UiWidget::MainPanel: {
+      uint32_t key = static_cast<uint32_t>(s.mode) | (static_cast<uint32_t>(s.btnBMode) << 4) |
+                     (s.connected ? 0x100u : 0u) | (s.tracking ? 0x200u : 0u) | (s.imuOk ? 0x400u : 0u) |
+                     (s.statsPage ? 0x800u : 0u) | (static_cast<uint32_t>(s.profileIndex) << 12) |
+                     (s.gestures ? 0x10000u : 0u) | (static_cast<uint32_t>(s.hostSlot) << 17) |
+                     (s.hostSaved ? 0x80000u : 0u) | (static_cast<uint32_t>(s.advPhase) << 20);
+      if (s.statsPage) {
+        // Shown in 0.1 ms steps; mix them in so any visible change redraws the panel.
+        const uint32_t stats[] = {s.latencyCount, s.latencyP50Us / 100, s.latencyP95Us / 100,
+                                  s.latencyP99Us / 100, s.latencyMaxUs / 100};
+        for (uint32_t v : stats) {
+          key = (key ^ v) * 16777619u;
+        }
+      }
+      return key;
+    }
+    case UiWidget::Battery:
+      return static_cast<uint32_t>(s.batteryPercent & 0xFFFF) | (s.batteryCharging ? 0x10000u : 0u);
+    default:
+      return 0;
+  }
+}
+
+void layoutStatusScreen(int w, int h) {
   const int margin = 6;
   const int headerY = 6;
   const int headerH = 24;
@@ -261,83 +737,134 @@ void drawStatusScreen() {
   const int mainY = row2Y + chipH + 6;
   const int mainH = max(44, h - mainY - margin);
 
-  if (!g_canvasReady || g_canvas.width() != w || g_canvas.height() != h) {
-    g_canvas.deleteSprite();
-    g_canvas.setColorDepth(16);
-    g_canvas.createSprite(w, h);
-    g_canvasReady = (g_canvas.width() == w && g_canvas.height() == h);
+  auto set = [](UiWidget widget, int x, int y, int rw, int rh) {
+    UiRect& r = g_widgetRects[static_cast<size_t>(widget)];
+    r.x = x;
+    r.y = y;
+    r.w = rw;
+    r.h = rh;
+  };
+  set(UiWidget::Header, margin, headerY, w - margin * 2, headerH);
+  set(UiWidget::ModeChip, margin, row1Y, chipW, chipH);
+  set(UiWidget::BtnBChip, margin + chipW + chipGap, row1Y, chipW, chipH);
+  set(UiWidget::TrackChip, margin, row2Y, chipW, chipH);
+  set(UiWidget::RestChip, margin + chipW + chipGap, row2Y, chipW, chipH);
+  set(UiWidget::MainPanel, margin, mainY, w - margin * 2, mainH);
+  set(UiWidget::Battery, w - margin - 84, mainY + mainH - 24, 78, 16);
+}
+
+// One 16-bit frame (about 65 KB at 135x240) retained for dirty-rectangle pushes. The board has
+// no PSRAM, so if the heap cannot hold it the status screen is drawn straight onto the panel.
+void ensureStatusCanvas(int w, int h) {
+  if (w == g_statusW && h == g_statusH) {
+    return;
   }
+  g_statusW = w;
+  g_statusH = h;
+  g_canvas.deleteSprite();
+  g_canvas.setColorDepth(16);
+  g_canvasReady = g_canvas.createSprite(w, h) != nullptr && g_canvas.width() == w && g_canvas.height() == h;
   if (!g_canvasReady) {
-    return;
+    g_canvas.deleteSprite();
+    logPrintf("[UI] no RAM for a %dx%d canvas, drawing to the panel directly\n", w, h);
   }
+  layoutStatusScreen(w, h);
+  g_uiValid = false;
+}
 
-  auto& cv = g_canvas;
-  cv.startWrite();
-  cv.setTextWrap(false, false);
-  drawGradientBackground(cv, w, h);
+lgfx::LGFXBase& statusTarget() {
+  if (g_canvasReady) {
+    return g_canvas;
+  }
+  return M5.Display;
+}
 
-  cv.fillRoundRect(margin, headerY, w - margin * 2, headerH, 7, kPanel);
-  cv.drawRoundRect(margin, headerY, w - margin * 2, headerH, 7, blend565(kAccent, TFT_WHITE, 0.5f));
+void drawHeader(lgfx::LGFXBase& cv, const UiRect& r, const UiSnapshot& s) {
+  cv.fillRoundRect(r.x, r.y, r.w, r.h, 7, kPanel);
+  cv.drawRoundRect(r.x, r.y, r.w, r.h, 7, blend565(kAccent, TFT_WHITE, 0.5f));
   cv.setTextColor(kAccent, kPanel);
   cv.setTextSize(1);
-  cv.setCursor(margin + 8, headerY + 8);
+  cv.setCursor(r.x + 8, r.y + 8);
   cv.print(kDeviceName);
-  const char* topState = connected ? "LINK" : "PAIR";
-  cv.setTextColor(connected ? kGood : kWarn, kPanel);
+  const char* topState = s.connected ? "LINK" : "PAIR";
+  cv.setTextColor(s.connected ? kGood : kWarn, kPanel);
   const int topW = cv.textWidth(topState);
-  cv.setCursor(w - margin - 8 - topW, headerY + 8);
+  cv.setCursor(r.x + r.w - 8 - topW, r.y + 8);
   cv.print(topState);
+}
 
-  drawChip(cv, margin, row1Y, chipW, chipH, "", (g_mode == UiMode::Menu) ? "MENU" : "LIVE", g_mode != UiMode::Menu, g_mode == UiMode::Menu ? kWarn : kAccent);
-  drawChip(cv, margin + chipW + chipGap, row1Y, chipW, chipH, "", btnBModeShort(g_btnBMode), g_btnBMode == BtnBMode::Scroll, g_btnBMode == BtnBMode::Scroll ? kAccent : kPanel2);
-  drawChip(cv, margin, row2Y, chipW, chipH, "TRK", g_trackingEnabled ? "ON" : "OFF", g_trackingEnabled, g_trackingEnabled ? kGood : kWarn);
-  drawChip(cv, margin + chipW + chipGap, row2Y, chipW, chipH, "RST", g_restLock ? "LOCK" : "FREE", g_restLock, g_restLock ? kWarn : kGood);
-
-  cv.fillRoundRect(margin, mainY, w - margin * 2, mainH, 8, kPanel);
-  cv.drawRoundRect(margin, mainY, w - margin * 2, mainH, 8, blend565(kPanel, TFT_WHITE, 0.35f));
+void drawMainPanel(lgfx::LGFXBase& cv, const UiRect& r, const UiSnapshot& s) {
+  cv.fillRoundRect(r.x, r.y, r.w, r.h, 8, kPanel);
+  cv.drawRoundRect(r.x, r.y, r.w, r.h, 8, blend565(kPanel, TFT_WHITE, 0.35f));
   cv.setTextColor(kTextPrimary, kPanel);
   cv.setTextSize(1);
 
-  int ty = mainY + 9;
-  const int tx = margin + 9;
+  int ty = r.y + 9;
+  const int tx = r.x + 9;
+  const int ruleW = r.x + r.w - 4 - tx;
   const int lineStep = 12;
 
-  if (g_mode == UiMode::Menu) {
+  if (s.mode == UiMode::Menu && s.statsPage) {
+    cv.setTextColor(kAccent, kPanel);
+    cv.setCursor(tx, ty);
+    cv.print("LATENCY IMU>BLE");
+    cv.setTextColor(kTextPrimary, kPanel);
+    ty += lineStep + 1;
+    cv.drawFastHLine(tx, ty, ruleW, blend565(kTextMuted, kPanel, 0.5f));
+    ty += lineStep - 1;
+    cv.setCursor(tx, ty); cv.printf("n    %lu", static_cast<unsigned long>(s.latencyCount));
+    ty += lineStep;
+    cv.setCursor(tx, ty); cv.printf("p50  %.1f ms", s.latencyP50Us / 1000.0f);
+    ty += lineStep;
+    cv.setCursor(tx, ty); cv.printf("p95  %.1f ms", s.latencyP95Us / 1000.0f);
+    ty += lineStep;
+    cv.setCursor(tx, ty); cv.printf("p99  %.1f ms", s.latencyP99Us / 1000.0f);
+    ty += lineStep;
+    cv.setCursor(tx, ty); cv.printf("max  %.1f ms", s.latencyMaxUs / 1000.0f);
+    ty += lineStep;
+    cv.setCursor(tx, ty); cv.print("Serial 'l' dump");
+    ty += lineStep;
+    cv.setCursor(tx, ty); cv.print("Hold A   back");
+  } else if (s.mode == UiMode::Menu) {
     cv.setTextColor(kWarn, kPanel);
     cv.setCursor(tx, ty);
     cv.print("MENU PAUSED");
     cv.setTextColor(kTextPrimary, kPanel);
     ty += lineStep + 1;
-    cv.drawFastHLine(tx, ty, w - (tx + margin + 4), blend565(kTextMuted, kPanel, 0.5f));
+    cv.drawFastHLine(tx, ty, ruleW, blend565(kTextMuted, kPanel, 0.5f));
     ty += lineStep - 1;
-    cv.setCursor(tx, ty); cv.printf("Track: %s", g_trackingEnabled ? "ON" : "OFF");
+    cv.setCursor(tx, ty); cv.printf("Track: %s (A)", s.tracking ? "ON" : "OFF");
     ty += lineStep;
-    cv.setCursor(tx, ty); cv.printf("Btn B: %s", btnBModeShort(g_btnBMode));
+    cv.setCursor(tx, ty); cv.printf("Btn B: %s (B)", btnBModeShort(s.btnBMode));
     ty += lineStep;
-    cv.setCursor(tx, ty); cv.printf("IMU: %s", imuOk ? "OK" : "ERR");
+    cv.setCursor(tx, ty); cv.printf("Feel: %s (AA)", kBallisticsProfiles[s.profileIndex].name);
     ty += lineStep;
-    cv.setCursor(tx, ty); cv.print("A   toggle track");
+    cv.setCursor(tx, ty); cv.printf("Gest: %s (BB)", s.gestures ? "ON" : "OFF");
     ty += lineStep;
-    cv.setCursor(tx, ty); cv.print("B   toggle B mode");
+    cv.setCursor(tx, ty); cv.printf("Host %u: %s (AAA)", s.hostSlot + 1u, s.hostSaved ? "SET" : "NEW");
     ty += lineStep;
-    cv.setCursor(tx, ty); cv.print("Hold B   pair mode");
+    cv.setCursor(tx, ty); cv.print("Hold: A lat B pair");
     ty += lineStep;
     cv.setCursor(tx, ty); cv.print("A+B recalibrate");
     ty += lineStep;
     cv.setCursor(tx, ty); cv.print("PWR resume");
-  } else if (!connected) {
+  } else if (!s.connected) {
     cv.setTextColor(kWarn, kPanel);
     cv.setCursor(tx, ty);
     cv.print("PAIR IN WINDOWS BT");
     cv.setTextColor(kTextPrimary, kPanel);
     ty += lineStep + 1;
-    cv.drawFastHLine(tx, ty, w - (tx + margin + 4), blend565(kTextMuted, kPanel, 0.5f));
+    cv.drawFastHLine(tx, ty, ruleW, blend565(kTextMuted, kPanel, 0.5f));
     ty += lineStep - 1;
-    cv.setCursor(tx, ty); cv.printf("Btn B: %s", btnBModeShort(g_btnBMode));
+    cv.setCursor(tx, ty); cv.printf("Btn B: %s", btnBModeShort(s.btnBMode));
     ty += lineStep;
-    cv.setCursor(tx, ty); cv.printf("IMU: %s", imuOk ? "OK" : "ERR");
+    cv.setCursor(tx, ty); cv.printf("IMU: %s", s.imuOk ? "OK" : "ERR");
     ty += lineStep;
-    cv.setCursor(tx, ty); cv.print("Add device");
+    if (s.hostSaved && s.advPhase != BleMouseAdvPhase::Open) {
+      cv.setCursor(tx, ty); cv.printf("Host %u: RECONN", s.hostSlot + 1u);
+    } else {
+      cv.setCursor(tx, ty); cv.printf("Host %u: add dev", s.hostSlot + 1u);
+    }
     ty += lineStep;
     cv.setCursor(tx, ty); cv.printf("Name: %s", kDeviceName);
     ty += lineStep;
@@ -348,15 +875,15 @@ void drawStatusScreen() {
     cv.print("READY");
     cv.setTextColor(kTextPrimary, kPanel);
     ty += lineStep + 1;
-    cv.drawFastHLine(tx, ty, w - (tx + margin + 4), blend565(kTextMuted, kPanel, 0.5f));
+    cv.drawFastHLine(tx, ty, ruleW, blend565(kTextMuted, kPanel, 0.5f));
     ty += lineStep - 1;
-    cv.setCursor(tx, ty); cv.printf("Btn B: %s", btnBModeShort(g_btnBMode));
+    cv.setCursor(tx, ty); cv.printf("Btn B: %s", btnBModeShort(s.btnBMode));
     ty += lineStep;
-    cv.setCursor(tx, ty); cv.printf("IMU: %s", imuOk ? "OK" : "ERR");
+    cv.setCursor(tx, ty); cv.printf("IMU: %s", s.imuOk ? "OK" : "ERR");
     ty += lineStep;
     cv.setCursor(tx, ty); cv.print("A   click / drag");
     ty += lineStep;
-    if (g_btnBMode == BtnBMode::Scroll) {
+    if (s.btnBMode == BtnBMode::Scroll) {
       cv.setCursor(tx, ty); cv.print("B   hold to scroll");
     } else {
       cv.setCursor(tx, ty); cv.print("B   right click");
@@ -366,34 +893,366 @@ void drawStatusScreen() {
     ty += lineStep;
     cv.setCursor(tx, ty); cv.print("PWR menu");
   }
+}
 
-  drawBatteryBadge(cv, w - margin - 84, mainY + mainH - 24, 78, 16);
+void drawWidget(lgfx::LGFXBase& cv, UiWidget widget, const UiRect& r, const UiSnapshot& s) {
+  switch (widget) {
+    case UiWidget::Header:
+      drawHeader(cv, r, s);
+      break;
+    case UiWidget::ModeChip:
+      drawChip(cv, r.x, r.y, r.w, r.h, "", (s.mode == UiMode::Menu) ? "MENU" : "LIVE", s.mode != UiMode::Menu, s.mode == UiMode::Menu ? kWarn : kAccent);
+      break;
+    case UiWidget::BtnBChip:
+      drawChip(cv, r.x, r.y, r.w, r.h, "", btnBModeShort(s.btnBMode), s.btnBMode == BtnBMode::Scroll, s.btnBMode == BtnBMode::Scroll ? kAccent : kPanel2);
+      break;
+    case UiWidget::TrackChip:
+      drawChip(cv, r.x, r.y, r.w, r.h, "TRK", s.tracking ? "ON" : "OFF", s.tracking, s.tracking ? kGood : kWarn);
+      break;
+    case UiWidget::RestChip:
+      drawChip(cv, r.x, r.y, r.w, r.h, "RST", s.restLock ? "LOCK" : "FREE", s.restLock, s.restLock ? kWarn : kGood);
+      break;
+    case UiWidget::MainPanel:
+      drawMainPanel(cv, r, s);
+      break;
+    case UiWidget::Battery:
+      drawBatteryBadge(cv, r.x, r.y, r.w, r.h);
+      break;
+    default:
+      break;
+  }
+}
 
-  cv.endWrite();
-  cv.pushSprite(0, 0);
+// ---- Display service -------------------------------------------------------------------
+// The display task on core 0 is the only code that touches the panel. Other tasks post
+// render requests; frames are composed into the retained canvas and the dirty rectangles are
+// streamed out with DMA through two small ping-pong band buffers.
+
+enum class DisplayRequestKind : uint8_t {
+  Status,
+  Overlay,
+  ClearOverlay,
+};
+
+struct DisplayRequest {
+  DisplayRequestKind kind;
+  UiSnapshot snap;
+  char headline[24];
+  char detail[32];
+  uint16_t color;
+  uint32_t holdMs;  // Overlay only; 0 keeps it until ClearOverlay or the next overlay
+};
+
+struct OverlayState {
+  bool active = false;
+  bool drawn = false;
+  char headline[24] = "";
+  char detail[32] = "";
+  uint16_t color = kAccent;
+  uint32_t untilMs = 0;
+};
+
+struct DisplayTimingStats {
+  uint32_t frames = 0;
+  uint32_t dropped = 0;
+  uint32_t renderUsMax = 0;
+  uint64_t renderUsSum = 0;
+  uint32_t transferUsMax = 0;
+  uint64_t transferUsSum = 0;
+  uint32_t rowsPushed = 0;
+  uint32_t widgetsDrawn = 0;
+};
+
+QueueHandle_t g_displayQueue = nullptr;
+uint32_t g_widgetsDrawn = 0;
+uint16_t* g_dmaBands[2] = {nullptr, nullptr};
+// Dirty column span per row; clean when x0 >= x1.
+int16_t g_dirtyX0[kMaxPanelRows];
+int16_t g_dirtyX1[kMaxPanelRows];
+OverlayState g_overlay;
+UiSnapshot g_lastSnap;
+bool g_haveSnap = false;
+portMUX_TYPE g_displayStatsMux = portMUX_INITIALIZER_UNLOCKED;
+DisplayTimingStats g_displayStats;
+
+void markDirty(int x, int y, int w, int h) {
+  const int x0 = max(0, x);
+  const int x1 = min(g_statusW, x + w);
+  const int y0 = max(0, y);
+  const int y1 = min(static_cast<int>(kMaxPanelRows), y + h);
+  if (x0 >= x1) {
+    return;
+  }
+  for (int row = y0; row < y1; ++row) {
+    if (g_dirtyX0[row] >= g_dirtyX1[row]) {
+      g_dirtyX0[row] = static_cast<int16_t>(x0);
+      g_dirtyX1[row] = static_cast<int16_t>(x1);
+    } else {
+      g_dirtyX0[row] = static_cast<int16_t>(min(static_cast<int>(g_dirtyX0[row]), x0));
+      g_dirtyX1[row] = static_cast<int16_t>(max(static_cast<int>(g_dirtyX1[row]), x1));
+    }
+  }
 }
 
-void drawCalibrationOverlay(const char* headline, const char* detail, uint16_t color) {
-  const int w = M5.Display.width();
-  const int h = M5.Display.height();
+void drawCalibrationOverlay(lgfx::LGFXBase& cv, const char* headline, const char* detail, uint16_t color) {
+  const int w = cv.width();
+  const int h = cv.height();
   const int boxW = w - 34;
   const int boxH = 58;
   const int x = (w - boxW) / 2;
   const int y = (h - boxH) / 2;
 
+  cv.fillRoundRect(x, y, boxW, boxH, 10, kPanel2);
+  cv.drawRoundRect(x, y, boxW, boxH, 10, color);
+  cv.setTextWrap(false, false);
+  cv.setTextColor(color, kPanel2);
+  cv.setTextSize((boxW >= 180) ? 2 : 1);
+  cv.setCursor(x + 10, y + 10);
+  cv.print(headline);
+  cv.setTextColor(kTextPrimary, kPanel2);
+  cv.setTextSize(1);
+  cv.setCursor(x + 10, y + 36);
+  cv.print(detail);
+  markDirty(x, y, boxW, boxH);
+}
+
+// Redraws widgets whose state changed into the retained canvas (or the panel, without one) and
+// marks their rectangles dirty.
+void composeStatusFrame(const UiSnapshot& snap) {
+  const int w = g_statusW;
+  const int h = g_statusH;
+  bool dirty[kUiWidgetCount];
+  bool anyDirty = false;
+  for (size_t i = 0; i < kUiWidgetCount; ++i) {
+    const uint32_t key = widgetStateKey(static_cast<UiWidget>(i), snap);
+    dirty[i] = !g_uiValid || key != g_widgetKeys[i];
+    g_widgetKeys[i] = key;
+    anyDirty |= dirty[i];
+  }
+  if (!anyDirty) {
+    return;
+  }
+  // The battery badge sits on top of the main panel and must be redrawn with it.
+  dirty[static_cast<size_t>(UiWidget::Battery)] |= dirty[static_cast<size_t>(UiWidget::MainPanel)];
+
+  lgfx::LGFXBase& cv = statusTarget();
+  cv.startWrite();
+  cv.setTextWrap(false, false);
+  if (!g_uiValid) {
+    drawGradientBackground(cv, 0, 0, w, h, h);
+    markDirty(0, 0, w, h);
+  }
+  for (size_t i = 0; i < kUiWidgetCount; ++i) {
+    if (!dirty[i]) {
+      continue;
+    }
+    const UiWidget widget = static_cast<UiWidget>(i);
+    const UiRect& r = g_widgetRects[i];
+    if (g_uiValid && widget != UiWidget::Battery) {
+      drawGradientBackground(cv, r.x, r.y, r.w, r.h, h);
+    }
+    drawWidget(cv, widget, r, snap);
+    markDirty(r.x, r.y, r.w, r.h);
+    ++g_widgetsDrawn;
+  }
+  cv.endWrite();
+  g_uiValid = true;
+  // Widgets under an active overlay were just repainted over it.
+  g_overlay.drawn = false;
+}
+
+// Streams every run of dirty rows to the panel, each run cut to the union of its rows' dirty
+// spans. While one band buffer is on the wire the next band is copied into the other, so the
+// CPU copy overlaps the SPI transfer. Without a canvas the widgets are already on the panel.
+uint32_t pushDirtyRows() {
+  const int w = g_statusW;
+  const int h = min(g_statusH, static_cast<int>(kMaxPanelRows));
+  if (!g_canvasReady) {
+    uint32_t rows = 0;
+    for (int y = 0; y < h; ++y) {
+      rows += g_dirtyX0[y] < g_dirtyX1[y] ? 1 : 0;
+      g_dirtyX0[y] = g_dirtyX1[y] = 0;
+    }
+    return rows;
+  }
+  const uint16_t* frame = static_cast<const uint16_t*>(g_canvas.getBuffer());
+  const bool useDma = g_dmaBands[0] != nullptr && g_dmaBands[1] != nullptr;
+  uint32_t rowsPushed = 0;
+  size_t band = 0;
+
   M5.Display.startWrite();
-  M5.Display.fillRoundRect(x, y, boxW, boxH, 10, kPanel2);
-  M5.Display.drawRoundRect(x, y, boxW, boxH, 10, color);
-  M5.Display.setTextWrap(false, false);
-  M5.Display.setTextColor(color, kPanel2);
-  M5.Display.setTextSize((boxW >= 180) ? 2 : 1);
-  M5.Display.setCursor(x + 10, y + 10);
-  M5.Display.print(headline);
-  M5.Display.setTextColor(kTextPrimary, kPanel2);
-  M5.Display.setTextSize(1);
-  M5.Display.setCursor(x + 10, y + 36);
-  M5.Display.print(detail);
+  int y = 0;
+  while (y < h) {
+    if (g_dirtyX0[y] >= g_dirtyX1[y]) {
+      ++y;
+      continue;
+    }
+    int x0 = w;
+    int x1 = 0;
+    int rows = 0;
+    while (y + rows < h && g_dirtyX0[y + rows] < g_dirtyX1[y + rows] && rows < static_cast<int>(kDisplayBandRows)) {
+      x0 = min(x0, static_cast<int>(g_dirtyX0[y + rows]));
+      x1 = max(x1, static_cast<int>(g_dirtyX1[y + rows]));
+      g_dirtyX0[y + rows] = g_dirtyX1[y + rows] = 0;
+      ++rows;
+    }
+    const int spanW = x1 - x0;
+    const uint16_t* src = frame + static_cast<size_t>(y) * w + x0;
+    if (useDma) {
+      uint16_t* dst = g_dmaBands[band];
+      for (int r = 0; r < rows; ++r) {
+        memcpy(dst + r * spanW, src + static_cast<size_t>(r) * w, spanW * sizeof(uint16_t));
+      }
+      M5.Display.pushImageDMA(x0, y, spanW, rows, reinterpret_cast<const lgfx::swap565_t*>(dst));
+      band ^= 1;
+    } else {
+      for (int r = 0; r < rows; ++r) {
+        M5.Display.pushImage(x0, y + r, spanW, 1,
+                             reinterpret_cast<const lgfx::swap565_t*>(src + static_cast<size_t>(r) * w));
+      }
+    }
+    rowsPushed += rows;
+    y += rows;
+  }
+  M5.Display.waitDMA();
   M5.Display.endWrite();
+  return rowsPushed;
+}
+
+void renderFrameNow() {
+  if (!g_haveSnap) {
+    return;
+  }
+  const uint32_t renderStartUs = micros();
+  ensureStatusCanvas(M5.Display.width(), M5.Display.height());
+  composeStatusFrame(g_lastSnap);
+  if (g_overlay.active && !g_overlay.drawn) {
+    drawCalibrationOverlay(statusTarget(), g_overlay.headline, g_overlay.detail, g_overlay.color);
+    g_overlay.drawn = true;
+  }
+  const uint32_t transferStartUs = micros();
+  const uint32_t rows = pushDirtyRows();
+  if (rows == 0) {
+    return;
+  }
+  const uint32_t renderUs = transferStartUs - renderStartUs;
+  const uint32_t transferUs = micros() - transferStartUs;
+
+  const uint32_t widgetsDrawn = g_widgetsDrawn;
+  g_widgetsDrawn = 0;
+  portENTER_CRITICAL(&g_displayStatsMux);
+  ++g_displayStats.frames;
+  g_displayStats.renderUsMax = max(g_displayStats.renderUsMax, renderUs);
+  g_displayStats.renderUsSum += renderUs;
+  g_displayStats.transferUsMax = max(g_displayStats.transferUsMax, transferUs);
+  g_displayStats.transferUsSum += transferUs;
+  g_displayStats.rowsPushed += rows;
+  g_displayStats.widgetsDrawn += widgetsDrawn;
+  portEXIT_CRITICAL(&g_displayStatsMux);
+}
+
+// Brackets rendering so motion samples taken meanwhile can be tagged for the latency stats.
+void renderFrame() {
+  g_displayBusy = true;
+  renderFrameNow();
+  g_displayBusy = false;
+}
+
+void handleDisplayRequest(const DisplayRequest& req) {
+  g_lastSnap = req.snap;
+  g_haveSnap = true;
+  switch (req.kind) {
+    case DisplayRequestKind::Status:
+      break;
+    case DisplayRequestKind::Overlay:
+      if (g_overlay.active) {
+        g_uiValid = false;  // Repaint whatever the previous overlay covered
+      }
+      g_overlay.active = true;
+      g_overlay.drawn = false;
+      strlcpy(g_overlay.headline, req.headline, sizeof(g_overlay.headline));
+      strlcpy(g_overlay.detail, req.detail, sizeof(g_overlay.detail));
+      g_overlay.color = req.color;
+      g_overlay.untilMs = req.holdMs ? (millis() + req.holdMs) : 0;
+      break;
+    case DisplayRequestKind::ClearOverlay:
+      if (g_overlay.active) {
+        g_overlay.active = false;
+        g_uiValid = false;
+      }
+      break;
+  }
+  renderFrame();
+}
+
+void displayTask(void* /*arg*/) {
+  for (;;) {
+    DisplayRequest req;
+    if (xQueueReceive(g_displayQueue, &req, pdMS_TO_TICKS(kStatusRefreshMs)) == pdTRUE) {
+      handleDisplayRequest(req);
+    }
+    if (g_overlay.active && g_overlay.untilMs != 0 &&
+        static_cast<int32_t>(millis() - g_overlay.untilMs) >= 0) {
+      g_overlay.active = false;
+      g_uiValid = false;
+      renderFrame();
+    }
+  }
+}
+
+bool postDisplayRequest(const DisplayRequest& req, TickType_t wait) {
+  if (g_displayQueue == nullptr || xQueueSend(g_displayQueue, &req, wait) != pdTRUE) {
+    portENTER_CRITICAL(&g_displayStatsMux);
+    ++g_displayStats.dropped;
+    portEXIT_CRITICAL(&g_displayStatsMux);
+    return false;
+  }
+  return true;
+}
+
+// Non-blocking; a status frame is simply skipped if the display task is behind.
+void requestStatusFrame() {
+  DisplayRequest req = {};
+  req.kind = DisplayRequestKind::Status;
+  req.snap = captureUiSnapshot();
+  postDisplayRequest(req, 0);
+}
+
+void showOverlay(const char* headline, const char* detail, uint16_t color, uint32_t holdMs) {
+  DisplayRequest req = {};
+  req.kind = DisplayRequestKind::Overlay;
+  req.snap = captureUiSnapshot();
+  strlcpy(req.headline, headline, sizeof(req.headline));
+  strlcpy(req.detail, detail, sizeof(req.detail));
+  req.color = color;
+  req.holdMs = holdMs;
+  postDisplayRequest(req, pdMS_TO_TICKS(kDisplayPostWaitMs));
+}
+
+void clearOverlay() {
+  DisplayRequest req = {};
+  req.kind = DisplayRequestKind::ClearOverlay;
+  req.snap = captureUiSnapshot();
+  postDisplayRequest(req, pdMS_TO_TICKS(kDisplayPostWaitMs));
+}
+
+DisplayTimingStats takeDisplayStats() {
+  portENTER_CRITICAL(&g_displayStatsMux);
+  const DisplayTimingStats stats = g_displayStats;
+  g_displayStats = DisplayTimingStats();
+  portEXIT_CRITICAL(&g_displayStatsMux);
+  return stats;
+}
+
+void beginDisplayService() {
+  g_displayQueue = xQueueCreate(kDisplayQueueDepth, sizeof(DisplayRequest));
+  const size_t bandBytes = static_cast<size_t>(M5.Display.width()) * kDisplayBandRows * sizeof(uint16_t);
+  g_dmaBands[0] = static_cast<uint16_t*>(heap_caps_malloc(bandBytes, MALLOC_CAP_DMA));
+  g_dmaBands[1] = static_cast<uint16_t*>(heap_caps_malloc(bandBytes, MALLOC_CAP_DMA));
+  M5.Display.initDMA();
+  logPrintf("[BOOT] display dma %s\n", (g_dmaBands[0] && g_dmaBands[1]) ? "on" : "off (no DMA RAM)");
+  xTaskCreatePinnedToCore(displayTask, "display", kDisplayTaskStack, nullptr,
+                          kDisplayTaskPriority, &g_displayTask, kUiTaskCore);
 }
 
 bool readGyro(float& x, float& y, float& z) {
@@ -410,336 +1269,1465 @@ bool readAccel(float& x, float& y, float& z) {
   return M5.Imu.getAccelData(&x, &y, &z);
 }
 
-void resetMotionIntegrators() {
-  g_filteredX = 0.0f;
-  g_filteredY = 0.0f;
-  g_accumX = 0.0f;
-  g_accumY = 0.0f;
-  g_accumWheel = 0.0f;
+MotionPipeline::Config makePipelineConfig() {
+  MotionPipeline::Config config;
+  config.scrollSensitivity = kScrollSensitivity;
+  config.wheelResolution = MOUSE_WHEEL_RESOLUTION;
+  config.deadzoneDps = kDeadzoneDps;
+  config.filter.minCutoffHz = kFilterMinCutoffHz;
+  config.filter.betaHzPerDps = kFilterBetaHzPerDps;
+  config.restGyroDps = kRestGyroDps;
+  config.restEnterMs = kRestEnterMs;
+  config.flatAccelZMin = kFlatAccelZMin;
+  config.flatAccelXYMax = kFlatAccelXYMax;
+  config.restWakeTightenMs = kRestWakeTightenMs;
+  config.restWakeGyroEarlyDps = kRestWakeGyroEarlyDps;
+  config.restWakeGyroLateDps = kRestWakeGyroLateDps;
+  config.restPickupTiltG = kRestPickupTiltG;
+  config.restPickupZMinG = kRestPickupZMinG;
+  config.clickStabilizeMs = kClickStabilizeMs;
+  config.clickSensitivityScale = kClickSensitivityScale;
+  config.clickDeadzoneDps = kClickDeadzoneDps;
+  return config;
 }
 
-void releaseAllMouseButtons() {
-  if (g_leftDown) {
-    bleMouse.release(MOUSE_LEFT);
-    g_leftDown = false;
-  }
-  if (g_rightDown) {
-    bleMouse.release(MOUSE_RIGHT);
-    g_rightDown = false;
-  }
+// Safe from any task: the motion task applies the reset before its next sample.
+void requestMotionReset() {
+  g_motionResetRequested = true;
 }
 
-void calibrateGyro(bool withCountdown) {
-  if (withCountdown) {
-    for (int sec = 3; sec > 0; --sec) {
-      drawStatusScreen();
-      char headline[24];
-      snprintf(headline, sizeof(headline), "Recal in %d", sec);
-      drawCalibrationOverlay(headline, "Keep still", kWarn);
-      Serial.printf("[IMU] recalibration countdown %d\n", sec);
-      const uint32_t t0 = millis();
-      while (millis() - t0 < 1000) {
-        M5.update();
-        delay(12);
-      }
-    }
-  }
+int16_t telemetryScale(float value, float scale) {
+  return static_cast<int16_t>(constrain(lroundf(value * scale), -32768L, 32767L));
+}
 
-  drawStatusScreen();
-  drawCalibrationOverlay("Calibrating", "Hold still...", kAccent);
+void telemetryImu(const ImuSample& sample, uint32_t timeUs) {
+  TelemetryImuRecord record;
+  record.gyro[0] = telemetryScale(sample.gx, kTelemetryGyroScale);
+  record.gyro[1] = telemetryScale(sample.gy, kTelemetryGyroScale);
+  record.gyro[2] = telemetryScale(sample.gz, kTelemetryGyroScale);
+  record.accel[0] = telemetryScale(sample.ax, kTelemetryAccelScale);
+  record.accel[1] = telemetryScale(sample.ay, kTelemetryAccelScale);
+  record.accel[2] = telemetryScale(sample.az, kTelemetryAccelScale);
+  record.tempCentiC = telemetryScale(sample.tempC, 100.0f);
+  g_motionTelemetry.write(record, timeUs);
+}
 
-  Serial.println("[IMU] calibration started");
+// Producer is the calling task's stream: motion task -> g_motionTelemetry, loop -> g_hidTelemetry.
+void telemetryState(TelemetryStream& stream, TelemetryEvent event, int32_t value) {
+  TelemetryStateRecord record;
+  record.event = static_cast<uint8_t>(event);
+  record.value = value;
+  stream.write(record, micros());
+}
 
-  float sumX = 0.0f;
-  float sumY = 0.0f;
-  float sumZ = 0.0f;
-  uint16_t goodSamples = 0;
+// HID loop side of onReportSent().
+void telemetryReport(const BleMouseSentReport& report) {
+  TelemetryReportRecord record;
+  record.buttons = report.buttons;
+  record.x = report.x;
+  record.y = report.y;
+  record.wheel = report.wheel;
+  record.hWheel = report.hWheel;
+  record.delivered = report.delivered ? 1 : 0;
+  g_hidTelemetry.write(record, report.timeUs);
+}
 
-  for (uint16_t i = 0; i < kCalibSamples; ++i) {
-    float x = 0.0f;
-    float y = 0.0f;
-    float z = 0.0f;
-    if (readGyro(x, y, z)) {
-      sumX += x;
-      sumY += y;
-      sumZ += z;
-      ++goodSamples;
-    }
-    delay(4);
+// Loop task: one latency sample per delivered report that carried queued motion.
+void recordReportLatency(const BleMouseSentReport& report) {
+  if (!g_latencyPending || !report.delivered ||
+      (report.x == 0 && report.y == 0 && report.wheel == 0 && report.hWheel == 0)) {
+    return;
   }
-
-  if (goodSamples > 0) {
-    g_bias.x = sumX / static_cast<float>(goodSamples);
-    g_bias.y = sumY / static_cast<float>(goodSamples);
-    g_bias.z = sumZ / static_cast<float>(goodSamples);
+  g_latencyPending = false;
+  const uint32_t us = report.timeUs - g_latencySampleUs;
+  g_latency.record(us);
+  for (size_t i = 0; i < kLatencyContextCount; ++i) {
+    if (g_latencyContext & (1u << i)) {
+      g_latencyByContext[i].record(us);
+    }
   }
-  resetMotionIntegrators();
-  g_restLock = false;
-  g_restCandidateMs = 0;
-  g_restLockSinceMs = 0;
-
-  Serial.printf("[IMU] calibration done samples=%u bias=(%.3f, %.3f, %.3f)\n",
-                goodSamples, g_bias.x, g_bias.y, g_bias.z);
+}
 
-  delay(180);
+LatencySummary summarizeLatency(const LatencyHistogram& h) {
+  LatencySummary summary;
+  summary.count = h.count();
+  summary.minUs = h.minUs();
+  summary.meanUs = h.meanUs();
+  summary.p50Us = h.percentileUs(50.0f);
+  summary.p95Us = h.percentileUs(95.0f);
+  summary.p99Us = h.percentileUs(99.0f);
+  summary.maxUs = h.maxUs();
+  return summary;
 }
 
-void enterPairingMode() {
-  releaseAllMouseButtons();
-  resetMotionIntegrators();
-  Serial.printf("[BLE] pairing request (pre connected=%d)\n", bleMouse.isConnected() ? 1 : 0);
-  const bool ok = bleMouse.startPairingMode();
-  delay(80);
-  Serial.printf("[BLE] pairing mode request -> %s (post connected=%d)\n",
-                ok ? "started" : "not ready",
-                bleMouse.isConnected() ? 1 : 0);
-  drawStatusScreen();
-  drawCalibrationOverlay(ok ? "PAIR MODE" : "PAIR WAIT",
-                         ok ? "Scan in host BT menu" : "BLE still starting",
-                         ok ? kAccent : kWarn);
+void printLatencyLine(const char* name, const LatencySummary& s) {
+  logPrintf("[LAT] %s n=%lu min=%lu mean=%lu p50=%lu p95=%lu p99=%lu max=%lu us\n", name,
+            static_cast<unsigned long>(s.count), static_cast<unsigned long>(s.minUs),
+            static_cast<unsigned long>(s.meanUs), static_cast<unsigned long>(s.p50Us),
+            static_cast<unsigned long>(s.p95Us), static_cast<unsigned long>(s.p99Us),
+            static_cast<unsigned long>(s.maxUs));
 }
 
-float applyDeadzone(float value, float deadzone) {
-  if (fabsf(value) < deadzone) {
-    return 0.0f;
+const char* const kLatencyContextNames[kLatencyContextCount] = {"display", "rest_wake", "click"};
+
+void dumpLatency() {
+  printLatencyLine("all", summarizeLatency(g_latency));
+  for (size_t i = 0; i < kLatencyContextCount; ++i) {
+    printLatencyLine(kLatencyContextNames[i], summarizeLatency(g_latencyByContext[i]));
+  }
+  logPrintf("[LAT] buckets_us");
+  for (size_t i = 0; i < LatencyHistogram::kBuckets; ++i) {
+    if (g_latency.bucket(i) != 0) {
+      logPrintf(" %lu:%lu", static_cast<unsigned long>((i + 1) * LatencyHistogram::kBucketUs),
+                static_cast<unsigned long>(g_latency.bucket(i)));
+    }
   }
-  return value;
+  logPrintf(" over:%lu\n", static_cast<unsigned long>(g_latency.overflow()));
 }
 
-void handleUiAndModeButtons() {
-  if (M5.BtnPWR.wasClicked()) {
-    g_mode = (g_mode == UiMode::AirMouse) ? UiMode::Menu : UiMode::AirMouse;
-    releaseAllMouseButtons();
-    Serial.printf("[UI] mode -> %s\n", modeToStr(g_mode));
+// Loop task: 'l' dumps the latency histogram, 'L' clears it.
+void handleSerialCommands() {
+  while (Serial.available() > 0) {
+    const int c = Serial.read();
+    if (c == 'l') {
+      dumpLatency();
+    } else if (c == 'L') {
+      g_latency.reset();
+      for (size_t i = 0; i < kLatencyContextCount; ++i) {
+        g_latencyByContext[i].reset();
+      }
+      logPrintf("[LAT] reset\n");
+    }
   }
+}
 
-  const bool bothHeldForRecalib = M5.BtnA.pressedFor(kRecalibHoldMs) && M5.BtnB.pressedFor(kRecalibHoldMs);
-  if (bothHeldForRecalib && !g_recalibLatch) {
-    g_recalibLatch = true;
-    calibrateGyro(true);
-  }
-  if (!M5.BtnA.isPressed() || !M5.BtnB.isPressed()) {
-    g_recalibLatch = false;
+// BleMouse observer; runs on the loop task inside service()/press()/release().
+void onReportSent(const BleMouseSentReport& report, void* /*context*/) {
+  recordReportLatency(report);
+  if (kTelemetryBinary) {
+    telemetryReport(report);
   }
+}
 
-  if (g_mode != UiMode::Menu) {
+// Loop task: turns UI and connection changes into state records.
+void updateTelemetryState() {
+  if (!kTelemetryBinary) {
     return;
   }
-
-  if (M5.BtnA.wasClicked()) {
-    g_trackingEnabled = !g_trackingEnabled;
-    Serial.printf("[UI] tracking -> %s\n", g_trackingEnabled ? "on" : "paused");
+  const bool connected = bleMouse.isConnected();
+  if (connected != g_telemetryConnected) {
+    g_telemetryConnected = connected;
+    // Connected carries the disconnect-to-connect time in ms.
+    telemetryState(g_hidTelemetry, connected ? TelemetryEvent::Connected : TelemetryEvent::Disconnected,
+                   connected ? static_cast<int32_t>(bleMouse.getReconnectStats().lastMs) : 0);
   }
-
-  if (M5.BtnB.wasClicked()) {
-    if (g_pairingClickSuppress) {
-      g_pairingClickSuppress = false;
-    } else {
-      g_btnBMode = (g_btnBMode == BtnBMode::RightClick) ? BtnBMode::Scroll : BtnBMode::RightClick;
-      Serial.printf("[UI] BtnB mode -> %s\n", btnBModeToStr(g_btnBMode));
-    }
+  if (g_mode != g_telemetryMode) {
+    g_telemetryMode = g_mode;
+    telemetryState(g_hidTelemetry, TelemetryEvent::ModeChanged, g_mode == UiMode::Menu ? 1 : 0);
   }
-
-  const bool bHeldForPairing = !M5.BtnA.isPressed() && M5.BtnB.pressedFor(kPairingHoldMs);
-  if (bHeldForPairing && !g_pairingLatch) {
-    g_pairingLatch = true;
-    g_pairingClickSuppress = true;
-    enterPairingMode();
+  if (g_trackingEnabled != g_telemetryTracking) {
+    g_telemetryTracking = g_trackingEnabled;
+    telemetryState(g_hidTelemetry, TelemetryEvent::TrackingChanged, g_trackingEnabled ? 1 : 0);
   }
-  if (!M5.BtnB.isPressed()) {
-    g_pairingLatch = false;
+  if (g_btnBMode != g_telemetryBtnBMode) {
+    g_telemetryBtnBMode = g_btnBMode;
+    telemetryState(g_hidTelemetry, TelemetryEvent::BtnBModeChanged, g_btnBMode == BtnBMode::RightClick ? 1 : 0);
   }
 }
 
-void updateClicks() {
-  if (!bleMouse.isConnected() || g_mode == UiMode::Menu) {
-    g_leftPressStartMs = 0;
-    releaseAllMouseButtons();
-    return;
+void releaseAllMouseButtons() {
+  if (g_leftDown) {
+    bleMouse.release(MOUSE_LEFT);
+    g_leftDown = false;
   }
+  if (g_rightDown) {
+    bleMouse.release(MOUSE_RIGHT);
+    g_rightDown = false;
+  }
+}
 
-  const bool aPressed = M5.BtnA.isPressed();
-  const bool bPressed = M5.BtnB.isPressed();
-
-  if (aPressed != g_leftDown) {
-    g_leftDown = aPressed;
-    if (g_leftDown) {
-      g_leftPressStartMs = millis();
-      resetMotionIntegrators();
-      bleMouse.press(MOUSE_LEFT);
-    } else {
-      g_leftPressStartMs = 0;
-      bleMouse.release(MOUSE_LEFT);
-    }
+void markBootPhase(BootPhase phase) {
+  uint32_t& slot = g_bootPhaseUs[static_cast<size_t>(phase)];
+  if (slot == 0) {
+    slot = max<uint32_t>(1, micros());
   }
+}
 
-  if (g_btnBMode == BtnBMode::RightClick) {
-    if (bPressed != g_rightDown) {
-      g_rightDown = bPressed;
-      if (g_rightDown) {
-        bleMouse.press(MOUSE_RIGHT);
-      } else {
-        bleMouse.release(MOUSE_RIGHT);
-      }
-    }
-  } else if (g_rightDown) {
-    bleMouse.release(MOUSE_RIGHT);
-    g_rightDown = false;
+const char* bootPhaseName(BootPhase phase) {
+  switch (phase) {
+    case BootPhase::HardwareReady: return "hw";
+    case BootPhase::BleAdvertising: return "adv";
+    case BootPhase::CalibrationLoaded: return "calib";
+    case BootPhase::MotionStarted: return "motion";
+    case BootPhase::FirstSample: return "sample";
+    case BootPhase::Connected: return "conn";
+    case BootPhase::FirstReport: return "report";
+    default: return "?";
   }
 }
 
-void updateMotion() {
+// Loop task: publishes the stats the UI task shows and applies its battery reading.
+void publishLoopStats() {
+  const int16_t battery = g_pendingBatteryLevel.exchange(-1, std::memory_order_relaxed);
+  if (battery >= 0) {
+    bleMouse.setBatteryLevel(static_cast<uint8_t>(battery));
+  }
   const uint32_t now = millis();
-  if (now - g_lastSampleMs < kSampleIntervalMs) {
+  const bool connected = bleMouse.isConnected();
+  // A connection change goes out at once so the [BLE] line never pairs it with old stats.
+  if (now - g_loopStatsMs < kLoopStatsPublishMs && connected == g_loopStats.connected) {
     return;
   }
+  g_loopStatsMs = now;
+  LoopStats stats;
+  stats.connected = connected;
+  stats.latency = summarizeLatency(g_latency);
+  stats.hid = bleMouse.getReportStats();
+  stats.link = bleMouse.getLinkStats();
+  stats.reconnect = bleMouse.getReconnectStats();
+  portENTER_CRITICAL(&g_loopStatsMux);
+  g_loopStats = stats;
+  portEXIT_CRITICAL(&g_loopStatsMux);
+}
 
-  const float dt = (now - g_lastSampleMs) / 1000.0f;
-  g_lastSampleMs = now;
+// Prints the boot timeline once the first HID report has gone out.
+void updateBootTimeline() {
+  if (g_bootTimelinePrinted) {
+    return;
+  }
+  if (bleMouse.isConnected()) {
+    markBootPhase(BootPhase::Connected);
+  }
+  if (bleMouse.getReportStats().sent == 0) {
+    return;
+  }
+  markBootPhase(BootPhase::FirstReport);
+  g_bootTimelinePrinted = true;
+
+  char line[160];
+  int len = snprintf(line, sizeof(line), "[BOOT] timeline_ms");
+  for (size_t i = 0; i < kBootPhaseCount && len > 0 && static_cast<size_t>(len) < sizeof(line); ++i) {
+    len += snprintf(line + len, sizeof(line) - len, " %s=%lu",
+                    bootPhaseName(static_cast<BootPhase>(i)),
+                    static_cast<unsigned long>(g_bootPhaseUs[i] / 1000));
+  }
+  logPrintf("%s\n", line);
+}
 
-  g_lastMoveX = 0;
-  g_lastMoveY = 0;
-  g_lastWheel = 0;
+bool loadTempBiasModel() {
+  Preferences prefs;
+  if (!prefs.begin(kPrefsNamespace, true)) {
+    return false;
+  }
+  TempBiasModel::State state = {};
+  const size_t len = prefs.getBytes(kPrefsTempBiasKey, &state, sizeof(state));
+  prefs.end();
+  if (len != sizeof(state) || !g_tempBias.restore(state)) {
+    return false;
+  }
+  g_savedTempBias = g_tempBias;
+  return true;
+}
 
-  if (!g_trackingEnabled || g_mode == UiMode::Menu || !bleMouse.isConnected()) {
-    resetMotionIntegrators();
-    g_restLock = false;
-    g_restCandidateMs = 0;
-    g_restLockSinceMs = 0;
+void saveTempBiasModel() {
+  // The motion task updates the model between samples; take the IMU lock for a consistent copy.
+  xSemaphoreTake(g_imuMutex, portMAX_DELAY);
+  const TempBiasModel snapshot = g_tempBias;
+  xSemaphoreGive(g_imuMutex);
+
+  const TempBiasModel::State state = snapshot.state();
+  Preferences prefs;
+  if (!prefs.begin(kPrefsNamespace, false)) {
+    logPrintf("[IMU] temperature model save failed (nvs)\n");
+    return;
+  }
+  const size_t written = prefs.putBytes(kPrefsTempBiasKey, &state, sizeof(state));
+  prefs.end();
+  if (written == sizeof(state)) {
+    g_savedTempBias = snapshot;
+  }
+}
+
+// True when the learned model moved far enough from the stored one to be worth a flash write.
+bool tempBiasModelChanged() {
+  if (g_tempBias.revision() == g_savedTempBias.revision() &&
+      g_tempBias.learnedBins() == g_savedTempBias.learnedBins()) {
+    return false;
+  }
+  if (g_tempBias.learnedBins() != g_savedTempBias.learnedBins()) {
+    return true;
+  }
+  const float tempC = g_lastTempC;
+  float now[3];
+  float saved[3];
+  g_tempBias.predict(tempC, now[0], now[1], now[2]);
+  g_savedTempBias.predict(tempC, saved[0], saved[1], saved[2]);
+  return fabsf(now[0] - saved[0]) > kBiasSaveDeltaDps ||
+         fabsf(now[1] - saved[1]) > kBiasSaveDeltaDps ||
+         fabsf(now[2] - saved[2]) > kBiasSaveDeltaDps;
+}
+
+GyroBias biasSnapshot() {
+  portENTER_CRITICAL(&g_biasMux);
+  const GyroBias bias = g_bias;
+  portEXIT_CRITICAL(&g_biasMux);
+  return bias;
+}
+
+void setBias(float x, float y, float z) {
+  portENTER_CRITICAL(&g_biasMux);
+  g_bias.x = x;
+  g_bias.y = y;
+  g_bias.z = z;
+  portEXIT_CRITICAL(&g_biasMux);
+}
+
+bool loadCalibration() {
+  Preferences prefs;
+  if (!prefs.begin(kPrefsNamespace, true)) {
+    return false;
+  }
+  CalibrationRecord record = {};
+  const size_t len = prefs.getBytes(kPrefsCalibrationKey, &record, sizeof(record));
+  prefs.end();
+  if (len != sizeof(record) || record.magic != kCalibrationMagic || record.version != kCalibrationVersion) {
+    return false;
+  }
+  if (!isfinite(record.biasX) || !isfinite(record.biasY) || !isfinite(record.biasZ)) {
+    return false;
+  }
+  g_savedCalibration = record;
+  setBias(record.biasX, record.biasY, record.biasZ);
+  g_lastTempC = record.tempC;
+  g_biasEstimator.reset(record.biasX, record.biasY, record.biasZ);
+
+  // Records written before the temperature model existed seed it with their single point.
+  const bool haveModel = loadTempBiasModel();
+  if (!haveModel) {
+    g_tempBias.observe(record.tempC, record.biasX, record.biasY, record.biasZ, kCalibrationModelWeight);
+  }
+  logPrintf("[IMU] loaded calibration source=%u bias=(%.3f, %.3f, %.3f) temp=%.1fC saves=%lu model_bins=%u%s\n",
+            record.source, record.biasX, record.biasY, record.biasZ, record.tempC,
+            static_cast<unsigned long>(record.saveCount), static_cast<unsigned>(g_tempBias.learnedBins()),
+            haveModel ? "" : " (seeded)");
+  return true;
+}
+
+void saveCalibration(CalibrationSource source, uint32_t samples) {
+  CalibrationRecord record = {};
+  record.magic = kCalibrationMagic;
+  record.version = kCalibrationVersion;
+  record.source = static_cast<uint8_t>(source);
+  const GyroBias bias = biasSnapshot();
+  record.biasX = bias.x;
+  record.biasY = bias.y;
+  record.biasZ = bias.z;
+  record.tempC = g_lastTempC;
+  record.samples = samples;
+  record.saveCount = g_savedCalibration.saveCount + 1;
+
+  Preferences prefs;
+  if (!prefs.begin(kPrefsNamespace, false)) {
+    logPrintf("[IMU] calibration save failed (nvs)\n");
+    return;
+  }
+  const size_t written = prefs.putBytes(kPrefsCalibrationKey, &record, sizeof(record));
+  prefs.end();
+  if (written == sizeof(record)) {
+    g_savedCalibration = record;
+  }
+  g_lastCalibrationSaveMs = millis();
+}
+
+// Before bleMouse.begin(), so the first advertising already targets the selected host.
+void loadHostSlots() {
+  Preferences prefs;
+  if (!prefs.begin(kPrefsNamespace, true)) {
+    return;
+  }
+  HostSlotsRecord record = {};
+  const size_t len = prefs.getBytes(kPrefsHostsKey, &record, sizeof(record));
+  prefs.end();
+  if (len != sizeof(record)) {
+    return;
+  }
+  bleMouse.restoreHosts(record.hosts, BLE_MOUSE_HOST_SLOTS, record.selected);
+  logPrintf("[BLE] host slot %u of %u selected (%s)\n", record.selected + 1u,
+            static_cast<unsigned>(BLE_MOUSE_HOST_SLOTS),
+            bleMouse.hasHost(bleMouse.getHostSlot()) ? "bonded" : "empty");
+}
+
+// UI task: the NimBLE host task changes slots on pairing; the loop task on slot selection.
+void updateHostPersistence() {
+  const uint32_t revision = bleMouse.getHostsRevision();
+  if (revision == g_savedHostsRevision) {
+    return;
+  }
+  HostSlotsRecord record = {};
+  record.selected = bleMouse.getHostSlot();
+  for (uint8_t i = 0; i < BLE_MOUSE_HOST_SLOTS; ++i) {
+    record.hosts[i] = bleMouse.getHost(i);
+  }
+  Preferences prefs;
+  if (!prefs.begin(kPrefsNamespace, false)) {
+    logPrintf("[BLE] host slots save failed (nvs)\n");
+    return;
+  }
+  const size_t written = prefs.putBytes(kPrefsHostsKey, &record, sizeof(record));
+  prefs.end();
+  if (written == sizeof(record)) {
+    g_savedHostsRevision = revision;
+  }
+}
+
+void loadMenuSettings() {
+  Preferences prefs;
+  if (!prefs.begin(kPrefsNamespace, true)) {
+    return;
+  }
+  const uint8_t index = prefs.getUChar(kPrefsProfileKey, 0);
+  g_gesturesEnabled = prefs.getBool(kPrefsGesturesKey, kGesturesDefaultOn);
+  prefs.end();
+  if (index < kBallisticsProfileCount) {
+    g_profileIndex = index;
+    g_profile.store(&kBallisticsProfiles[index], std::memory_order_release);
+  }
+}
+
+// UI task: stores the menu settings after they have been left alone for a moment, so cycling
+// through every feel costs one flash write.
+void updateSettingsPersistence() {
+  if (!g_settingsDirty || millis() - g_settingsChangedMs < kSettingsSaveDelayMs) {
+    return;
+  }
+  g_settingsDirty = false;
+  Preferences prefs;
+  if (!prefs.begin(kPrefsNamespace, false)) {
+    logPrintf("[UI] settings save failed (nvs)\n");
+    return;
+  }
+  prefs.putUChar(kPrefsProfileKey, g_profileIndex);
+  prefs.putBool(kPrefsGesturesKey, g_gesturesEnabled);
+  prefs.end();
+}
+
+void markSettingsDirty() {
+  g_settingsChangedMs = millis();
+  g_settingsDirty = true;
+}
+
+// Loop task.
+void selectBallisticsProfile(uint8_t index) {
+  g_profileIndex = index;
+  g_profile.store(&kBallisticsProfiles[index], std::memory_order_release);
+  markSettingsDirty();
+  logPrintf("[UI] feel -> %s\n", kBallisticsProfiles[index].name);
+}
+
+// Loop task.
+void setGesturesEnabled(bool enabled) {
+  g_gesturesEnabled = enabled;
+  markSettingsDirty();
+  logPrintf("[UI] gestures -> %s\n", enabled ? "on" : "off");
+}
+
+// UI task: writes flagged calibrations right away and the learned temperature model at a
+// limited rate.
+void updateCalibrationPersistence() {
+  if (g_calibrationDirty) {
+    g_calibrationDirty = false;
+    saveCalibration(g_calibrationSource, g_calibrationSource == CalibrationSource::Full ? kCalibSamples : kBootCheckSamples);
+    saveTempBiasModel();
+    return;
+  }
+  if (millis() - g_lastCalibrationSaveMs < kBiasSaveIntervalMs) {
+    return;
+  }
+  if (tempBiasModelChanged()) {
+    saveCalibration(CalibrationSource::Background, g_biasEstimator.acceptedWindows());
+    saveTempBiasModel();
+  } else {
+    g_lastCalibrationSaveMs = millis();
+  }
+}
+
+// Motion task: bias for the current die temperature. Falls back to the plain background
+// estimate until the model has learned at least one temperature.
+void updateBiasForTemperature(float tempC) {
+  GyroBias bias;
+  if (g_tempBias.ready()) {
+    g_tempBias.predict(tempC, bias.x, bias.y, bias.z);
+  } else {
+    bias.x = g_biasEstimator.biasX();
+    bias.y = g_biasEstimator.biasY();
+    bias.z = g_biasEstimator.biasZ();
+  }
+  setBias(bias.x, bias.y, bias.z);
+}
+
+void startBootBiasCheck() {
+  g_bootCheck = BootBiasCheck();
+  g_bootCheck.active = true;
+  g_bootCheck.startMs = millis();
+}
+
+// Motion task: validates the stored bias against one still window right after boot.
+// Pointing already uses the stored bias meanwhile; a mismatch replaces it in place.
+void updateBootBiasCheck(const ImuSample& sample, uint32_t now) {
+  if (!g_bootCheck.active) {
+    return;
+  }
+  if (now - g_bootCheck.startMs > kBootCheckTimeoutMs) {
+    g_bootCheck.active = false;
+    g_bootCheckReport.timedOut = true;
+    g_bootCheckReport.atMs = now;
+    g_bootCheckReport.ready.store(true, std::memory_order_release);
+    return;
+  }
+  const float g[3] = {sample.gx, sample.gy, sample.gz};
+  for (int i = 0; i < 3; ++i) {
+    g_bootCheck.sum[i] += g[i];
+    g_bootCheck.sumSq[i] += g[i] * g[i];
+  }
+  if (++g_bootCheck.count < kBootCheckSamples) {
+    return;
+  }
+
+  const float n = static_cast<float>(g_bootCheck.count);
+  float mean[3];
+  bool still = true;
+  for (int i = 0; i < 3; ++i) {
+    mean[i] = g_bootCheck.sum[i] / n;
+    const float var = g_bootCheck.sumSq[i] / n - mean[i] * mean[i];
+    still = still && var < kBootCheckMaxStdDps * kBootCheckMaxStdDps;
+  }
+  if (!still) {
+    // Moving: start a new window but keep the original deadline.
+    const uint32_t startMs = g_bootCheck.startMs;
+    g_bootCheck = BootBiasCheck();
+    g_bootCheck.active = true;
+    g_bootCheck.startMs = startMs;
+    return;
+  }
+
+  g_bootCheck.active = false;
+  const bool mismatch = fabsf(mean[0] - g_bias.x) > kBootBiasToleranceDps ||
+                        fabsf(mean[1] - g_bias.y) > kBootBiasToleranceDps ||
+                        fabsf(mean[2] - g_bias.z) > kBootBiasToleranceDps;
+  g_bootCheckReport.replaced = mismatch;
+  g_bootCheckReport.atMs = now;
+  for (int i = 0; i < 3; ++i) {
+    g_bootCheckReport.measured[i] = mean[i];
+  }
+  g_bootCheckReport.ready.store(true, std::memory_order_release);
+  if (mismatch) {
+    setBias(mean[0], mean[1], mean[2]);
+    g_biasEstimator.reset(mean[0], mean[1], mean[2]);
+    g_tempBias.observe(sample.tempC, mean[0], mean[1], mean[2], kCalibrationModelWeight);
+    g_calibrationSource = CalibrationSource::BootCheck;
+    g_calibrationDirty = true;
+  }
+}
+
+// UI task: prints the boot check result once the motion task has one.
+void reportBootBiasCheck() {
+  if (!g_bootCheckReport.ready.exchange(false, std::memory_order_acquire)) {
+    return;
+  }
+  const BootCheckReport& r = g_bootCheckReport;
+  if (r.timedOut) {
+    logPrintf("[IMU] boot check timed out at %lu ms (device moving), keeping stored bias\n",
+              static_cast<unsigned long>(r.atMs));
+    return;
+  }
+  logPrintf("[IMU] boot check at %lu ms: measured=(%.3f, %.3f, %.3f) %s\n",
+            static_cast<unsigned long>(r.atMs), r.measured[0], r.measured[1], r.measured[2],
+            r.replaced ? "-> replacing stored bias" : "ok");
+}
+
+const char* powerStateToStr(PowerState state) {
+  return state == PowerState::Idle ? "idle" : "active";
+}
+
+// Motion task with g_imuMutex held. Changing the FIFO rate discards the
+// buffered frames, so the decimator restarts from its warm-up on the next active tick.
+void setPowerState(PowerState state, uint32_t now) {
+  if (state == g_powerState) {
     return;
   }
+  if (g_powerState == PowerState::Idle) {
+    g_idleMsTotal += now - g_powerStateSinceMs;
+  }
+  g_powerStateSinceMs = now;
+  g_quietSinceMs = now;
+  if (g_imuFifo.ready()) {
+    g_imuFifo.setOutputRate(state == PowerState::Idle ? kIdleOdrHz : Mpu6886Fifo::kOdrHz);
+    g_decimator.reset();
+  }
+  g_powerState = state;
+}
 
-  float gx = 0.0f;
-  float gy = 0.0f;
-  float gz = 0.0f;
-  if (!readGyro(gx, gy, gz)) {
+// Drops to idle once the pointer has had nothing to do for kIdleEnterMs; any motion that
+// releases the rest lock, or leaving the menu, wakes it on the same sample.
+void updatePowerState(uint32_t now) {
+  const bool quiet = g_pipeline.restLocked() || g_mode == UiMode::Menu || !g_trackingEnabled ||
+                     !bleMouse.isConnected() || g_bootCheck.active;
+  // Calibration samples at the full rate.
+  const bool calibrating = g_calibration.phase.load(std::memory_order_relaxed) != CalibrationPhase::Off;
+  if (!quiet || calibrating) {
+    g_quietSinceMs = now;
+    setPowerState(PowerState::Active, now);
     return;
   }
+  if (g_powerState == PowerState::Active && now - g_quietSinceMs >= kIdleEnterMs) {
+    setPowerState(PowerState::Idle, now);
+  }
+}
 
-  float activeDeadzone = kDeadzoneDps;
-  float sensitivityX = kSensitivityX;
-  float sensitivityY = kSensitivityY;
+// Loop task (or setup). Samples are taken by the motion task from its ordinary FIFO samples,
+// so they are evenly spaced on the sensor's clock and nothing blocks while they accumulate.
+void beginCalibrationSampling(uint32_t now, bool afterCountdown) {
+  GyroCalibration& c = g_calibration;
+  c.samples = 0;
+  c.sum[0] = c.sum[1] = c.sum[2] = 0.0f;
+  c.tempSum = 0.0f;
+  c.phaseStartMs = now;
+  c.phase.store(CalibrationPhase::Sampling, std::memory_order_release);
+
+  showOverlay("Calibrating", "Hold still...", kAccent, 0);
+  if (kTelemetryBinary) {
+    telemetryState(g_hidTelemetry, TelemetryEvent::CalibrationStart, afterCountdown ? 1 : 0);
+  } else {
+    logPrintf("[IMU] calibration started\n");
+  }
+}
 
-  // Click stabilization: suppress initial shake and reduce movement while holding left-click.
-  if (M5.BtnA.isPressed()) {
-    if (g_leftPressStartMs && (now - g_leftPressStartMs < kClickStabilizeMs)) {
-      resetMotionIntegrators();
+// Loop task (or setup). Ignored while a calibration is already running.
+void startCalibration(bool withCountdown) {
+  GyroCalibration& c = g_calibration;
+  if (c.phase.load(std::memory_order_acquire) != CalibrationPhase::Off) {
+    return;
+  }
+  const uint32_t now = millis();
+  if (!withCountdown) {
+    beginCalibrationSampling(now, false);
+    return;
+  }
+  c.phaseStartMs = now;
+  c.countdownShown = 0;
+  c.phase.store(CalibrationPhase::Countdown, std::memory_order_release);
+}
+
+// Motion task with g_imuMutex held: one sample of a running calibration. The last one sets
+// the bias and hands the result back to the loop task.
+void addCalibrationSample(const ImuSample& sample, uint32_t now) {
+  GyroCalibration& c = g_calibration;
+  c.sum[0] += sample.gx;
+  c.sum[1] += sample.gy;
+  c.sum[2] += sample.gz;
+  c.tempSum += sample.tempC;
+  if (++c.samples < kCalibSamples) {
+    return;
+  }
+
+  const float n = static_cast<float>(c.samples);
+  const float bx = c.sum[0] / n;
+  const float by = c.sum[1] / n;
+  const float bz = c.sum[2] / n;
+  setBias(bx, by, bz);
+  g_biasEstimator.reset(bx, by, bz);
+  g_bootCheck.active = false;
+  g_tempBias.observe(c.tempSum / n, bx, by, bz, kCalibrationModelWeight);
+  g_calibrationSource = CalibrationSource::Full;
+  g_calibrationDirty = true;
+  g_pipeline.reset();
+  c.phaseStartMs = now;
+  c.phase.store(CalibrationPhase::Done, std::memory_order_release);
+}
+
+// Loop task: steps the countdown and reports the result. The countdown is posted to the
+// display task as ordinary overlay frames.
+void updateCalibration(uint32_t now) {
+  GyroCalibration& c = g_calibration;
+  switch (c.phase.load(std::memory_order_acquire)) {
+    case CalibrationPhase::Countdown: {
+      const uint32_t elapsedS = (now - c.phaseStartMs) / 1000u;
+      if (elapsedS >= kCalibCountdownS) {
+        beginCalibrationSampling(now, true);
+        return;
+      }
+      const uint8_t sec = static_cast<uint8_t>(kCalibCountdownS - elapsedS);
+      if (sec == c.countdownShown) {
+        return;
+      }
+      c.countdownShown = sec;
+      char headline[24];
+      snprintf(headline, sizeof(headline), "Recal in %u", sec);
+      showOverlay(headline, "Keep still", kWarn, 0);
+      if (!kTelemetryBinary) {
+        logPrintf("[IMU] recalibration countdown %u\n", sec);
+      }
       return;
     }
-    activeDeadzone = max(activeDeadzone, kClickDeadzoneDps);
-    sensitivityX *= kClickSensitivityScale;
-    sensitivityY *= kClickSensitivityScale;
-  }
-
-  gx = applyDeadzone(gx - g_bias.x, activeDeadzone);
-  gy = applyDeadzone(gy - g_bias.y, activeDeadzone);
-  gz = applyDeadzone(gz - g_bias.z, activeDeadzone);
-
-  // Desk-rest lock: when device is still and lying flat for a short period,
-  // freeze motion so the pointer does not drift while set down.
-  float ax = 0.0f;
-  float ay = 0.0f;
-  float az = 0.0f;
-  const bool haveAccel = readAccel(ax, ay, az);
-  const bool lowGyro = fabsf(gx) < kRestGyroDps && fabsf(gy) < kRestGyroDps && fabsf(gz) < kRestGyroDps;
-  const bool flatDesk = haveAccel && fabsf(az) > kFlatAccelZMin && fabsf(ax) < kFlatAccelXYMax && fabsf(ay) < kFlatAccelXYMax;
-  if (!g_restLock) {
-    if (lowGyro && flatDesk) {
-      if (g_restCandidateMs == 0) {
-        g_restCandidateMs = now;
-      } else if (now - g_restCandidateMs >= kRestEnterMs) {
-        g_restLock = true;
-        g_restLockSinceMs = now;
-        g_restCandidateMs = 0;
-        resetMotionIntegrators();
+    case CalibrationPhase::Sampling: {
+      if (now - c.phaseStartMs < kCalibTimeoutMs) {
+        return;
       }
-    } else {
-      g_restCandidateMs = 0;
+      // No IMU samples (sensor gone): keep the old bias. The motion task may still be adding
+      // one, so only the count is reported.
+      CalibrationPhase expected = CalibrationPhase::Sampling;
+      if (!c.phase.compare_exchange_strong(expected, CalibrationPhase::Closing, std::memory_order_acq_rel)) {
+        return;  // Finished just now; reported on the next pass
+      }
+      c.phaseStartMs = now;
+      if (kTelemetryBinary) {
+        telemetryState(g_hidTelemetry, TelemetryEvent::CalibrationDone, 0);
+      } else {
+        logPrintf("[IMU] calibration timed out samples=%u, keeping bias\n", c.samples);
+      }
+      return;
     }
+    case CalibrationPhase::Done:
+      if (kTelemetryBinary) {
+        telemetryState(g_hidTelemetry, TelemetryEvent::CalibrationDone, c.samples);
+      } else {
+        const GyroBias bias = biasSnapshot();
+        logPrintf("[IMU] calibration done samples=%u bias=(%.3f, %.3f, %.3f) temp=%.1fC\n",
+                  c.samples, bias.x, bias.y, bias.z, c.tempSum / c.samples);
+      }
+      c.phaseStartMs = now;
+      c.phase.store(CalibrationPhase::Closing, std::memory_order_release);
+      return;
+    case CalibrationPhase::Closing:
+      if (now - c.phaseStartMs >= kCalibDoneHoldMs) {
+        clearOverlay();
+        c.phase.store(CalibrationPhase::Off, std::memory_order_release);
+      }
+      return;
+    default:
+      return;
+  }
+}
+
+// Returns at once; when a host was connected, BleMouse opens advertising after the disconnect.
+void enterPairingMode() {
+  releaseAllMouseButtons();
+  requestMotionReset();
+  const bool preConnected = bleMouse.isConnected();
+  const bool ok = bleMouse.startPairingMode();
+  if (kTelemetryBinary) {
+    telemetryState(g_hidTelemetry, TelemetryEvent::PairingRequested, ok ? 1 : 0);
+  } else {
+    logPrintf("[BLE] pairing mode request -> %s (pre connected=%d disconnecting=%d)\n",
+              ok ? "started" : "not ready", preConnected ? 1 : 0,
+              bleMouse.isPairingPending() ? 1 : 0);
+  }
+  showOverlay(ok ? "PAIR MODE" : "PAIR WAIT",
+              ok ? "Scan in host BT menu" : "BLE still starting",
+              ok ? kAccent : kWarn, kStatusRefreshMs);
+}
+
+void handleUiAndModeButtons() {
+  if (M5.BtnPWR.wasClicked()) {
+    g_mode = (g_mode == UiMode::AirMouse) ? UiMode::Menu : UiMode::AirMouse;
+    releaseAllMouseButtons();
+    logPrintf("[UI] mode -> %s\n", modeToStr(g_mode));
+  }
+
+  const bool bothHeldForRecalib = M5.BtnA.pressedFor(kRecalibHoldMs) && M5.BtnB.pressedFor(kRecalibHoldMs);
+  if (bothHeldForRecalib && !g_recalibLatch) {
+    g_recalibLatch = true;
+    startCalibration(true);
+  }
+  if (!M5.BtnA.isPressed() || !M5.BtnB.isPressed()) {
+    g_recalibLatch = false;
+  }
+
+  if (g_mode != UiMode::Menu) {
+    return;
+  }
+
+  // Single clicks are decided after the double-click window, so a double click never also
+  // toggles tracking.
+  if (M5.BtnA.wasSingleClicked()) {
+    g_trackingEnabled = !g_trackingEnabled;
+    logPrintf("[UI] tracking -> %s\n", g_trackingEnabled ? "on" : "paused");
+  }
+  if (M5.BtnA.wasDoubleClicked()) {
+    selectBallisticsProfile(static_cast<uint8_t>((g_profileIndex + 1) % kBallisticsProfileCount));
+  }
+  if (M5.BtnA.wasDecideClickCount() && M5.BtnA.getClickCount() == 3) {
+    const uint8_t slot = static_cast<uint8_t>((bleMouse.getHostSlot() + 1) % BLE_MOUSE_HOST_SLOTS);
+    releaseAllMouseButtons();
+    bleMouse.selectHostSlot(slot);
+    logPrintf("[UI] host slot -> %u (%s)\n", slot + 1u, bleMouse.hasHost(slot) ? "bonded" : "empty");
+  }
+
+  // A long press never registers as a click, so neither hold below needs click suppression.
+  const bool aHeldForStats = !M5.BtnB.isPressed() && M5.BtnA.pressedFor(kStatsHoldMs);
+  if (aHeldForStats && !g_statsLatch) {
+    g_statsLatch = true;
+    g_statsPage = !g_statsPage;
+  }
+  if (!M5.BtnA.isPressed()) {
+    g_statsLatch = false;
+  }
+
+  if (M5.BtnB.wasSingleClicked()) {
+    g_btnBMode = (g_btnBMode == BtnBMode::RightClick) ? BtnBMode::Scroll : BtnBMode::RightClick;
+    logPrintf("[UI] BtnB mode -> %s\n", btnBModeToStr(g_btnBMode));
+  }
+  if (M5.BtnB.wasDoubleClicked()) {
+    setGesturesEnabled(!g_gesturesEnabled);
+  }
+
+  const bool bHeldForPairing = !M5.BtnA.isPressed() && M5.BtnB.pressedFor(kPairingHoldMs);
+  if (bHeldForPairing && !g_pairingLatch) {
+    g_pairingLatch = true;
+    enterPairingMode();
+  }
+  if (!M5.BtnB.isPressed()) {
+    g_pairingLatch = false;
+  }
+}
+
+void setLeftButton(bool down) {
+  if (down == g_leftDown) {
+    return;
+  }
+  g_leftDown = down;
+  if (down) {
+    requestMotionReset();
+    bleMouse.press(MOUSE_LEFT);
   } else {
-    const uint32_t lockedFor = now - g_restLockSinceMs;
-    const float wakeGyro = (lockedFor >= kRestWakeTightenMs) ? kRestWakeGyroLateDps : kRestWakeGyroEarlyDps;
-    const bool pickedUp = haveAccel && (fabsf(ax) > kRestPickupTiltG || fabsf(ay) > kRestPickupTiltG || fabsf(az) < kRestPickupZMinG);
-    const bool wakeByGyro = fabsf(gx) > wakeGyro || fabsf(gy) > wakeGyro || fabsf(gz) > wakeGyro;
-    if (pickedUp || wakeByGyro) {
-      g_restLock = false;
-      g_restCandidateMs = 0;
-      g_restLockSinceMs = 0;
-      resetMotionIntegrators();
+    bleMouse.release(MOUSE_LEFT);
+  }
+}
+
+void setRightButton(bool down) {
+  if (down == g_rightDown) {
+    return;
+  }
+  g_rightDown = down;
+  if (down) {
+    bleMouse.press(MOUSE_RIGHT);
+  } else {
+    bleMouse.release(MOUSE_RIGHT);
+  }
+}
+
+void recordClickLatency(uint32_t us) {
+  portENTER_CRITICAL(&g_clickLatencyMux);
+  ++g_clickLatency.edges;
+  g_clickLatency.sumUs += us;
+  g_clickLatency.maxUs = max(g_clickLatency.maxUs, us);
+  portEXIT_CRITICAL(&g_clickLatencyMux);
+}
+
+ClickLatencyStats takeClickLatency() {
+  portENTER_CRITICAL(&g_clickLatencyMux);
+  const ClickLatencyStats stats = g_clickLatency;
+  g_clickLatency = ClickLatencyStats();
+  portEXIT_CRITICAL(&g_clickLatencyMux);
+  return stats;
+}
+
+// Replays captured edges in order, so a press and release that both happened since the last
+// pass still reach the host as a click; button edges are sent without waiting for the
+// connection interval. Edges from the menu or while disconnected are dropped, not replayed.
+void updateClicks() {
+  const uint32_t nowUs = micros();
+  g_buttons.settle(nowUs);
+  const bool active = bleMouse.isConnected() && g_mode != UiMode::Menu;
+  if (!active) {
+    releaseAllMouseButtons();
+  }
+  const bool rightClickMode = g_btnBMode == BtnBMode::RightClick;
+  ButtonEdge edge;
+  while (g_buttons.pop(edge)) {
+    if (!active) {
+      continue;
+    }
+    if (edge.button == CapturedButton::A) {
+      setLeftButton(edge.pressed);
+    } else if (rightClickMode) {
+      setRightButton(edge.pressed);
     } else {
-      resetMotionIntegrators();
-      return;
+      continue;
+    }
+    recordClickLatency(micros() - edge.timeUs);
+  }
+  if (!active) {
+    return;
+  }
+  // Catches up after a queue overflow, and presses held since before the menu closed.
+  setLeftButton(g_buttons.held(CapturedButton::A));
+  setRightButton(rightClickMode && g_buttons.held(CapturedButton::B));
+}
+
+void recordSamplePeriod(uint32_t periodUs) {
+  const uint32_t nominalUs = kSampleIntervalMs * 1000;
+  const uint32_t devUs = (periodUs > nominalUs) ? periodUs - nominalUs : nominalUs - periodUs;
+  portENTER_CRITICAL(&g_jitterMux);
+  ++g_jitter.count;
+  g_jitter.minUs = min(g_jitter.minUs, periodUs);
+  g_jitter.maxUs = max(g_jitter.maxUs, periodUs);
+  g_jitter.sumUs += periodUs;
+  g_jitter.sumAbsDevUs += devUs;
+  if (periodUs > nominalUs + kLateSampleSlackUs) {
+    ++g_jitter.late;
+  }
+  portEXIT_CRITICAL(&g_jitterMux);
+}
+
+// Feeds one bias-corrected sample to the orientation filter and accounts its cycle cost.
+void updateOrientation(const ImuSample& raw, float dt) {
+  ImuSample corrected = raw;
+  corrected.gx -= g_bias.x;
+  corrected.gy -= g_bias.y;
+  corrected.gz -= g_bias.z;
+  const uint32_t c0 = ESP.getCycleCount();
+  g_orientation.update(corrected, dt);
+  const uint32_t cycles = ESP.getCycleCount() - c0;
+
+  portENTER_CRITICAL(&g_jitterMux);
+  ++g_jitter.fusionUpdates;
+  g_jitter.fusionCyclesSum += cycles;
+  g_jitter.fusionCyclesMax = max(g_jitter.fusionCyclesMax, cycles);
+  if (cycles > kFusionCycleBudget) {
+    ++g_jitter.fusionOverBudget;
+  }
+  portEXIT_CRITICAL(&g_jitterMux);
+}
+
+SampleJitterStats takeJitterStats() {
+  portENTER_CRITICAL(&g_jitterMux);
+  const SampleJitterStats stats = g_jitter;
+  g_jitter = SampleJitterStats();
+  portEXIT_CRITICAL(&g_jitterMux);
+  return stats;
+}
+
+void emitMotion(const PointerDelta& out, uint8_t context, uint32_t sampleUs) {
+  MotionDelta delta;
+  delta.x = out.x;
+  delta.y = out.y;
+  delta.wheel = out.wheel;
+  delta.context = context;
+  delta.sampleUs = sampleUs;
+  g_motionQueue.push(delta);
+}
+
+// Motion task. Gestures are watched while pointing with no button held; nullptr disarms.
+void updateGestures(const MotionInput* in) {
+  const bool armed = in != nullptr && g_gesturesEnabled && !in->buttons.left && !in->buttons.scroll;
+  if (!armed) {
+    if (g_gesturesArmed) {
+      g_gestures.reset();
+      g_gesturesArmed = false;
+    }
+    return;
+  }
+  g_gesturesArmed = true;
+  PROFILE_STAGE(ProfileStage::MotionGesture);
+  float yawDps = 0.0f;
+  float pitchDps = 0.0f;
+  pointingRates(in->upX, in->upY, in->upZ, in->gx, in->gy, in->gz, yawDps, pitchDps);
+  // Same screen axes as the pointer: right is -yaw, down is +pitch.
+  const Gesture gesture = g_gestures.update(-yawDps, pitchDps, in->dt);
+  if (gesture != Gesture::None) {
+    GestureEvent event;
+    event.gesture = gesture;
+    event.score = g_gestures.lastScore();
+    g_gestureQueue.push(event);
+  }
+}
+
+// Runs on the motion task with g_imuMutex held, once per 250 Hz motion sample.
+void processMotionSample(const ImuSample& sample, bool haveAccel, float dt, uint32_t now, uint32_t sampleUs) {
+  if (g_motionResetRequested) {
+    g_motionResetRequested = false;
+    g_pipeline.resetIntegrators();
+  }
+
+  markBootPhase(BootPhase::FirstSample);
+
+  const CalibrationPhase calibration = g_calibration.phase.load(std::memory_order_acquire);
+  if (calibration != CalibrationPhase::Off) {
+    if (calibration == CalibrationPhase::Sampling) {
+      addCalibrationSample(sample, now);
+    }
+    g_pipeline.reset();
+    updateGestures(nullptr);
+    return;
+  }
+
+  // Every still window, on the desk or in the hand, is a bias measurement at the current die
+  // temperature; the model turns those into a bias for whatever temperature we are at now.
+  if (g_biasEstimator.addSample(sample.gx, sample.gy, sample.gz, g_pipeline.restLocked())) {
+    g_tempBias.observe(sample.tempC, g_biasEstimator.windowMeanX(), g_biasEstimator.windowMeanY(),
+                       g_biasEstimator.windowMeanZ());
+  }
+  updateBiasForTemperature(sample.tempC);
+  updateBootBiasCheck(sample, now);
+
+  if (!g_trackingEnabled || g_mode == UiMode::Menu || !bleMouse.isConnected()) {
+    g_pipeline.reset();
+    updateGestures(nullptr);
+    return;
+  }
+
+  MotionInput in;
+  in.timestampMs = now;
+  in.dt = dt;
+  in.gx = sample.gx - g_bias.x;
+  in.gy = sample.gy - g_bias.y;
+  in.gz = sample.gz - g_bias.z;
+  in.ax = sample.ax;
+  in.ay = sample.ay;
+  in.az = sample.az;
+  in.haveAccel = haveAccel;
+  g_orientation.upVector(in.upX, in.upY, in.upZ);
+  // Judged at the frame's own timestamp: a frame sampled before the press is not stabilized.
+  in.buttons.left = g_buttons.heldAt(CapturedButton::A, sampleUs);
+  in.buttons.scroll = g_btnBMode == BtnBMode::Scroll && g_buttons.heldAt(CapturedButton::B, sampleUs);
+  in.profile = g_profile.load(std::memory_order_acquire);
+
+  PointerDelta out;
+  const bool moved = g_pipeline.process(in, out);
+  updateGestures(&in);
+  if (g_latencyRestLock && !g_pipeline.restLocked()) {
+    g_restWakeUntilMs = now + kRestWakeLatencyMs;
+  }
+  g_latencyRestLock = g_pipeline.restLocked();
+  if (moved) {
+    uint8_t context = 0;
+    context |= g_displayBusy ? kLatencyDisplayBusy : 0;
+    context |= static_cast<int32_t>(g_restWakeUntilMs - now) > 0 ? kLatencyRestWake : 0;
+    context |= in.buttons.left ? kLatencyClickHeld : 0;
+    emitMotion(out, context, sampleUs);
+  }
+  if (kTelemetryBinary) {
+    TelemetryDeltaRecord record;
+    record.x = out.x;
+    record.y = out.y;
+    record.wheel = out.wheel;
+    record.flags = (g_pipeline.restLocked() ? kTelemetryFlagRestLock : 0) |
+                   (in.buttons.left ? kTelemetryFlagLeft : 0) |
+                   (in.buttons.scroll ? kTelemetryFlagScroll : 0);
+    g_motionTelemetry.write(record, micros());
+    if (g_pipeline.restLocked() != g_telemetryRestLock) {
+      g_telemetryRestLock = g_pipeline.restLocked();
+      telemetryState(g_motionTelemetry, TelemetryEvent::RestLockChanged, g_telemetryRestLock ? 1 : 0);
+    }
+  }
+}
+
+// Runs on the motion task with g_imuMutex held.
+void updateMotion() {
+  const uint32_t now = millis();
+  const uint32_t nowUs = micros();
+  const uint32_t periodUs = nowUs - g_lastSampleUs;
+  g_lastSampleUs = nowUs;
+  ++g_motionWakeups;
+  // Idle ticks and the first tick after waking run on a different period; keep them out of the
+  // 250 Hz jitter figures.
+  const bool active = g_powerState == PowerState::Active;
+  if (active && g_lastTickPowerState == PowerState::Active) {
+    recordSamplePeriod(periodUs);
+  }
+  g_lastTickPowerState = g_powerState;
+
+  if (g_imuFifo.ready() && !active) {
+    // Idle: 100 Hz frames skip the decimator, whose taps are designed for 1 kHz input.
+    ImuSample frames[Mpu6886Fifo::kMaxFramesPerRead];
+    const size_t count = g_imuFifo.read(frames, Mpu6886Fifo::kMaxFramesPerRead);
+    const uint32_t frameUs = 1000000u / g_imuFifo.outputRate();
+    const float frameDt = 1.0f / g_imuFifo.outputRate();
+    for (size_t i = 0; i < count; ++i) {
+      const uint32_t sampleUs = nowUs - static_cast<uint32_t>(count - 1 - i) * frameUs;
+      if (kTelemetryBinary) {
+        telemetryImu(frames[i], sampleUs);
+      }
+      updateOrientation(frames[i], frameDt);
+      g_lastTempC = frames[i].tempC;
+      g_lastGyroX = frames[i].gx;
+      g_lastGyroY = frames[i].gy;
+      g_lastGyroZ = frames[i].gz;
+      processMotionSample(frames[i], true, frameDt, now, sampleUs);
     }
+    updatePowerState(now);
+    return;
   }
 
-  if (g_btnBMode == BtnBMode::Scroll && M5.BtnB.isPressed()) {
-    g_accumWheel += gx * kScrollSensitivity * dt;
-    const int wheel = static_cast<int>(lroundf(g_accumWheel));
-    if (wheel != 0) {
-      g_accumWheel -= static_cast<float>(wheel);
-      const int8_t clampedWheel = static_cast<int8_t>(constrain(wheel, -127, 127));
-      bleMouse.move(0, 0, clampedWheel, 0);
-      g_lastWheel = clampedWheel;
+  if (g_imuFifo.ready()) {
+    // One burst drains every 1 kHz frame since the last tick; the decimator
+    // band-limits them and hands back 250 Hz samples on the sensor's own clock.
+    ImuSample frames[Mpu6886Fifo::kMaxFramesPerRead];
+    const size_t count = g_imuFifo.read(frames, Mpu6886Fifo::kMaxFramesPerRead);
+    for (size_t i = 0; i < count; ++i) {
+      if (kTelemetryBinary) {
+        // Frames are 1 ms apart; the newest one was read just now.
+        telemetryImu(frames[i], nowUs - static_cast<uint32_t>(count - 1 - i) * 1000u);
+      }
+      updateOrientation(frames[i], kFifoFrameDt);
+      ImuSample sample;
+      if (!g_decimator.push(frames[i], sample)) {
+        continue;
+      }
+      g_lastTempC = sample.tempC;
+      g_lastGyroX = sample.gx;
+      g_lastGyroY = sample.gy;
+      g_lastGyroZ = sample.gz;
+      const uint32_t frameUs = nowUs - static_cast<uint32_t>(count - 1 - i) * 1000u;
+      processMotionSample(sample, true, kDecimatedSampleDt, now, frameUs);
     }
+    updatePowerState(now);
+    return;
+  }
+
+  ImuSample sample;
+  if (!readGyro(sample.gx, sample.gy, sample.gz)) {
     return;
   }
+  if (now - g_lastPollTempMs >= kPollTempIntervalMs) {
+    float tempC = 0.0f;
+    if (M5.Imu.getTemp(&tempC)) {
+      g_lastTempC = tempC;
+    }
+    g_lastPollTempMs = now;
+  }
+  sample.tempC = g_lastTempC;
+  if (kTelemetryBinary) {
+    telemetryImu(sample, nowUs);
+  }
+  const bool haveAccel = readAccel(sample.ax, sample.ay, sample.az);
+  const float dt = periodUs / 1000000.0f;
+  if (haveAccel) {
+    updateOrientation(sample, dt);
+  }
+  processMotionSample(sample, haveAccel, dt, now, nowUs);
+  updatePowerState(now);
+}
+
+void motionTask(void* /*arg*/) {
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    const bool idle = g_powerState == PowerState::Idle;
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(idle ? kIdleSampleIntervalMs : kSampleIntervalMs));
+    if (xSemaphoreTake(g_imuMutex, 0) != pdTRUE) {
+      continue;  // saveTempBiasModel() is copying the model; the FIFO keeps the samples
+    }
+    {
+      PROFILE_STAGE(ProfileStage::MotionUpdate);
+      updateMotion();
+    }
+    xSemaphoreGive(g_imuMutex);
+  }
+}
 
-  // Gyro orientation mapping:
-  // X uses yaw-like axis (gz) so left/right feels like pointing.
-  // Y keeps pitch-like axis (gx), matching existing up/down feel.
-  const float angularSpeed = sqrtf(gz * gz + gx * gx);
-  const float accelNorm = constrain(angularSpeed / kAccelCurveRefDps, 0.0f, 1.0f);
-  const float accelFactor = 1.0f + kAccelCurveGain * powf(accelNorm, 1.35f);
+// HID side of the hand-off: forwards queued deltas to BLE from the loop task.
+void drainMotionQueue() {
+  MotionDelta delta;
+  bool any = false;
+  while (g_motionQueue.pop(delta)) {
+    bleMouse.moveHighRes(delta.x, delta.y, delta.wheel);
+    // Latency is measured from the oldest sample not yet covered by a sent report.
+    if (!g_latencyPending) {
+      g_latencyPending = true;
+      g_latencySampleUs = delta.sampleUs;
+      g_latencyContext = 0;
+    }
+    g_latencyContext |= delta.context;
+    if (!any) {
+      g_lastMoveX = 0;
+      g_lastMoveY = 0;
+      g_lastWheel = 0;
+      any = true;
+    }
+    g_lastMoveX += delta.x;
+    g_lastMoveY += delta.y;
+    g_lastWheel += delta.wheel;
+  }
+}
 
-  const float rawMoveX = -gz * sensitivityX * accelFactor * dt;
-  const float rawMoveY = gx * sensitivityY * accelFactor * dt;
+void runGestureAction(GestureAction action) {
+  switch (action) {
+    case GestureAction::LeftClick:
+      bleMouse.click(MOUSE_LEFT);
+      break;
+    case GestureAction::RightClick:
+      bleMouse.click(MOUSE_RIGHT);
+      break;
+    case GestureAction::MiddleClick:
+      bleMouse.click(MOUSE_MIDDLE);
+      break;
+    case GestureAction::Back:
+      bleMouse.click(MOUSE_BACK);
+      break;
+    case GestureAction::Forward:
+      bleMouse.click(MOUSE_FORWARD);
+      break;
+    case GestureAction::WheelUp:
+    case GestureAction::WheelDown: {
+      const int16_t detent = (action == GestureAction::WheelUp) ? MOUSE_WHEEL_RESOLUTION : -MOUSE_WHEEL_RESOLUTION;
+      bleMouse.moveHighRes(0, 0, detent);
+      break;
+    }
+    case GestureAction::PageUp:
+      bleMouse.tapKey(KEYBOARD_PAGE_UP);
+      break;
+    case GestureAction::PageDown:
+      bleMouse.tapKey(KEYBOARD_PAGE_DOWN);
+      break;
+    case GestureAction::LaserPointer:
+      bleMouse.tapKey(KEYBOARD_L, KEYBOARD_MOD_LEFT_CTRL);
+      break;
+    case GestureAction::Blackout:
+      bleMouse.tapKey(KEYBOARD_B);
+      break;
+    case GestureAction::VolumeUp:
+      bleMouse.tapConsumer(CONSUMER_VOLUME_UP);
+      break;
+    case GestureAction::VolumeDown:
+      bleMouse.tapConsumer(CONSUMER_VOLUME_DOWN);
+      break;
+    case GestureAction::PlayPause:
+      bleMouse.tapConsumer(CONSUMER_PLAY_PAUSE);
+      break;
+    default:
+      break;
+  }
+}
 
-  g_filteredX = (1.0f - kFilterAlpha) * g_filteredX + kFilterAlpha * rawMoveX;
-  g_filteredY = (1.0f - kFilterAlpha) * g_filteredY + kFilterAlpha * rawMoveY;
+// HID side of the gesture hand-off; gestures recognized before a disconnect or menu entry are
+// dropped rather than replayed.
+void drainGestureQueue() {
+  GestureEvent event;
+  while (g_gestureQueue.pop(event)) {
+    if (!bleMouse.isConnected() || g_mode == UiMode::Menu) {
+      continue;
+    }
+    const GestureAction action = kGestureActions[static_cast<size_t>(event.gesture)];
+    runGestureAction(action);
+    if (kTelemetryBinary) {
+      telemetryState(g_hidTelemetry, TelemetryEvent::GestureRecognized, static_cast<uint32_t>(event.gesture));
+    } else {
+      logPrintf("[GESTURE] %s score=%.3f action=%u\n", gestureName(event.gesture), event.score,
+                static_cast<unsigned>(action));
+    }
+  }
+}
 
-  g_accumX += g_filteredX;
-  g_accumY += g_filteredY;
+// One line per task: stage=min/mean/max us, with !n for calls over the stage budget.
+void printProfileLine(const char* task, ProfileStage first, ProfileStage last) {
+  if (!IMUPOINTER_PROFILE) {
+    return;
+  }
+  const uint32_t cyclesPerUs = ESP.getCpuFreqMHz();
+  char line[200];
+  int len = snprintf(line, sizeof(line), "[PROF] %s", task);
+  for (size_t i = static_cast<size_t>(first); i <= static_cast<size_t>(last); ++i) {
+    if (len <= 0 || static_cast<size_t>(len) >= sizeof(line)) {
+      break;
+    }
+    const ProfileStage stage = static_cast<ProfileStage>(i);
+    const StageStats st = profileTake(stage);
+    const uint32_t meanCycles = st.calls ? st.sumCycles / st.calls : 0;
+    len += snprintf(line + len, sizeof(line) - len, " %s=%lu/%lu/%lu", profileStageInfo(stage).name,
+                    static_cast<unsigned long>(st.minCycles / cyclesPerUs),
+                    static_cast<unsigned long>(meanCycles / cyclesPerUs),
+                    static_cast<unsigned long>(st.maxCycles / cyclesPerUs));
+    if (st.overruns != 0 && len > 0 && static_cast<size_t>(len) < sizeof(line)) {
+      len += snprintf(line + len, sizeof(line) - len, "!%lu", static_cast<unsigned long>(st.overruns));
+    }
+  }
+  logPrintf("%s\n", line);
+}
 
-  const int moveX = static_cast<int>(lroundf(g_accumX));
-  const int moveY = static_cast<int>(lroundf(g_accumY));
+// Loop task: follows the motion task's power state with the matching connection parameters
+// and reports how long the central took to apply each change. A disconnected device always
+// asks for the fast profile so a new connection starts responsive.
+void updateLinkPower() {
+  const PowerState state = g_powerState;
+  const BleMouseLinkProfile profile = (state == PowerState::Idle && bleMouse.isConnected())
+                                          ? BleMouseLinkProfile::Idle
+                                          : BleMouseLinkProfile::Fast;
+  if (profile != g_linkProfile) {
+    g_linkProfile = profile;
+    const bool requested = bleMouse.setLinkProfile(profile);
+    if (kTelemetryBinary) {
+      telemetryState(g_hidTelemetry, TelemetryEvent::PowerStateChanged, state == PowerState::Idle ? 1 : 0);
+    } else {
+      logPrintf("[PWR] %s sample_ms=%lu link=%s requested=%d\n",
+                powerStateToStr(state),
+                static_cast<unsigned long>(state == PowerState::Idle ? kIdleSampleIntervalMs : kSampleIntervalMs),
+                profile == BleMouseLinkProfile::Idle ? "idle" : "fast",
+                requested ? 1 : 0);
+    }
+  }
 
-  if (moveX != 0 || moveY != 0) {
-    g_accumX -= static_cast<float>(moveX);
-    g_accumY -= static_cast<float>(moveY);
+  const BleMouseLinkStats link = bleMouse.getLinkStats();
+  if (link.updates != g_linkUpdatesSeen) {
+    g_linkUpdatesSeen = link.updates;
+    if (!kTelemetryBinary) {
+      logPrintf("[PWR] link interval_us=%lu latency=%u applied_ms=%lu\n",
+                static_cast<unsigned long>(link.intervalUs),
+                static_cast<unsigned>(link.peripheralLatency),
+                static_cast<unsigned long>(link.lastUpdateUs / 1000));
+    }
+  }
+}
 
-    const int8_t clampedX = static_cast<int8_t>(constrain(moveX, -127, 127));
-    const int8_t clampedY = static_cast<int8_t>(constrain(moveY, -127, 127));
-    bleMouse.move(clampedX, clampedY, 0, 0);
-    g_lastMoveX = clampedX;
-    g_lastMoveY = clampedY;
+// Estimated draw of the parts the governor controls (motion-task wakes and attended connection
+// events); the display, CPU idle and sensor floor are not included. The PMIC reading is printed
+// when the board has a fuel gauge that reports current.
+void printPowerLine(uint32_t now, const BleMouseLinkStats& link) {
+  const uint32_t windowMs = now - g_powerReportMs;
+  if (windowMs == 0) {
+    return;
+  }
+  // Word-sized reads of motion-task counters; a pair torn by a state change skews one line.
+  const PowerState state = g_powerState;
+  uint32_t idleMs = g_idleMsTotal;
+  if (state == PowerState::Idle) {
+    idleMs += now - g_powerStateSinceMs;
+  }
+  const uint32_t wakeups = g_motionWakeups;
+  const uint32_t idlePct = min<uint32_t>(100, (idleMs - g_powerReportIdleMs) * 100 / windowMs);
+  const float wakeupsPerSec = (wakeups - g_powerReportWakeups) * 1000.0f / windowMs;
+  g_powerReportMs = now;
+  g_powerReportIdleMs = idleMs;
+  g_powerReportWakeups = wakeups;
+
+  const float eventsPerSec = (bleMouse.isConnected() && link.intervalUs > 0)
+                                 ? 1000000.0f / (link.intervalUs * (link.peripheralLatency + 1u))
+                                 : 0.0f;
+  const float estMa = (wakeupsPerSec * kMotionWakeChargeUc + eventsPerSec * kRadioEventChargeUc) / 1000.0f;
+  const int32_t measuredMa = M5.Power.getBatteryCurrent();
+
+  char line[200];
+  int len = snprintf(line, sizeof(line),
+                     "[PWR] state=%s idle=%lu%% wakeups=%.0f/s link(int_us=%lu lat=%u req=%lu upd=%lu) est_ma=%.2f",
+                     powerStateToStr(state),
+                     static_cast<unsigned long>(idlePct),
+                     wakeupsPerSec,
+                     static_cast<unsigned long>(link.intervalUs),
+                     static_cast<unsigned>(link.peripheralLatency),
+                     static_cast<unsigned long>(link.requests),
+                     static_cast<unsigned long>(link.updates),
+                     estMa);
+  if (measuredMa != 0 && len > 0 && static_cast<size_t>(len) < sizeof(line)) {
+    snprintf(line + len, sizeof(line) - len, " meas_ma=%ld", static_cast<long>(measuredMa));
   }
+  logPrintf("%s\n", line);
 }
 
 void updateDebugOutput() {
+  if (kTelemetryBinary) {
+    return;  // The serial port carries binary records instead
+  }
   const uint32_t now = millis();
   if (now - g_lastDebugMs < kDebugRefreshMs) {
     return;
   }
   g_lastDebugMs = now;
 
-  const bool connected = bleMouse.isConnected();
+  const LoopStats loopStats = loopStatsSnapshot();
+  const bool connected = loopStats.connected;
   if (connected != g_prevConnected) {
-    Serial.printf("[BLE] %s\n", connected ? "connected" : "disconnected");
+    if (connected) {
+      const BleMouseReconnectStats& reconnect = loopStats.reconnect;
+      logPrintf("[BLE] connected host=%u via=%s after_ms=%lu\n", bleMouse.getHostSlot() + 1u,
+                advPhaseToStr(reconnect.lastPhase), static_cast<unsigned long>(reconnect.lastMs));
+    } else {
+      logPrintf("[BLE] disconnected\n");
+    }
     g_prevConnected = connected;
   }
 
-  Serial.printf("[STATE] mode=%s ble=%d imu=%d track=%d rest=%d bmode=%s gyro=(%.2f,%.2f,%.2f) move=(%d,%d,%d) btn(A:%d B:%d P:%d)\n",
-                modeToStr(g_mode),
-                connected ? 1 : 0,
-                M5.Imu.isEnabled() ? 1 : 0,
-                g_trackingEnabled ? 1 : 0,
-                g_restLock ? 1 : 0,
-                btnBModeToStr(g_btnBMode),
-                g_lastGyroX, g_lastGyroY, g_lastGyroZ,
-                g_lastMoveX, g_lastMoveY, g_lastWheel,
-                M5.BtnA.isPressed() ? 1 : 0,
-                M5.BtnB.isPressed() ? 1 : 0,
-                M5.BtnPWR.isPressed() ? 1 : 0);
+  logPrintf("[STATE] mode=%s ble=%d imu=%d track=%d rest=%d bmode=%s feel=%s gest=%d host=%u adv=%s gyro=(%.2f,%.2f,%.2f) move=(%d,%d,%d) btn(A:%d B:%d P:%d)\n",
+            modeToStr(g_mode),
+            connected ? 1 : 0,
+            M5.Imu.isEnabled() ? 1 : 0,
+            g_trackingEnabled ? 1 : 0,
+            g_pipeline.restLocked() ? 1 : 0,
+            btnBModeToStr(g_btnBMode),
+            g_profile.load(std::memory_order_relaxed)->name,
+            g_gesturesEnabled ? 1 : 0,
+            bleMouse.getHostSlot() + 1u,
+            advPhaseToStr(bleMouse.getAdvPhase()),
+            g_lastGyroX.load(std::memory_order_relaxed), g_lastGyroY.load(std::memory_order_relaxed),
+            g_lastGyroZ.load(std::memory_order_relaxed),
+            g_lastMoveX, g_lastMoveY, g_lastWheel,
+            g_buttons.held(CapturedButton::A) ? 1 : 0,
+            g_buttons.held(CapturedButton::B) ? 1 : 0,
+            M5.BtnPWR.isPressed() ? 1 : 0);
+
+  const ClickLatencyStats clicks = takeClickLatency();
+  if (clicks.edges > 0) {
+    logPrintf("[BTN] edges=%lu edge_to_hid_us(avg=%lu max=%lu) bounces=%lu qdrop=%lu\n",
+              static_cast<unsigned long>(clicks.edges),
+              static_cast<unsigned long>(clicks.sumUs / clicks.edges),
+              static_cast<unsigned long>(clicks.maxUs),
+              static_cast<unsigned long>(g_buttons.bounces()),
+              static_cast<unsigned long>(g_buttons.dropped()));
+  }
+
+  const SampleJitterStats jitter = takeJitterStats();
+  if (jitter.count > 0) {
+    logPrintf("[TIMING] samples=%lu period_us(min=%lu avg=%lu max=%lu) jitter_us=%lu late=%lu qdrop=%lu fifo_ovf=%lu fusion_cyc(avg=%lu max=%lu over=%lu)\n",
+              static_cast<unsigned long>(jitter.count),
+              static_cast<unsigned long>(jitter.minUs),
+              static_cast<unsigned long>(jitter.sumUs / jitter.count),
+              static_cast<unsigned long>(jitter.maxUs),
+              static_cast<unsigned long>(jitter.sumAbsDevUs / jitter.count),
+              static_cast<unsigned long>(jitter.late),
+              static_cast<unsigned long>(g_motionQueue.dropped()),
+              static_cast<unsigned long>(g_imuFifo.overflows()),
+              static_cast<unsigned long>(jitter.fusionUpdates ? jitter.fusionCyclesSum / jitter.fusionUpdates : 0),
+              static_cast<unsigned long>(jitter.fusionCyclesMax),
+              static_cast<unsigned long>(jitter.fusionOverBudget));
+  }
+
+  const GyroBias bias = biasSnapshot();
+  logPrintf("[BIAS] bias=(%.3f,%.3f,%.3f) temp=%.1fC model(bins=%u slope=%.3f,%.3f,%.3f dps/C) var=%.2e windows(ok=%lu rejected=%lu)\n",
+            bias.x, bias.y, bias.z, g_lastTempC,
+            static_cast<unsigned>(g_tempBias.learnedBins()),
+            g_tempBias.slopeDpsPerC(0), g_tempBias.slopeDpsPerC(1), g_tempBias.slopeDpsPerC(2),
+            g_biasEstimator.varianceDps2(),
+            static_cast<unsigned long>(g_biasEstimator.acceptedWindows()),
+            static_cast<unsigned long>(g_biasEstimator.rejectedWindows()));
+
+  const DisplayTimingStats display = takeDisplayStats();
+  if (display.frames > 0) {
+    logPrintf("[UI] frames=%lu widgets=%lu rows=%lu render_us(avg=%lu max=%lu) dma_us(avg=%lu max=%lu) dropped=%lu\n",
+              static_cast<unsigned long>(display.frames),
+              static_cast<unsigned long>(display.widgetsDrawn),
+              static_cast<unsigned long>(display.rowsPushed),
+              static_cast<unsigned long>(display.renderUsSum / display.frames),
+              static_cast<unsigned long>(display.renderUsMax),
+              static_cast<unsigned long>(display.transferUsSum / display.frames),
+              static_cast<unsigned long>(display.transferUsMax),
+              static_cast<unsigned long>(display.dropped));
+  }
+
+  const BleMouseReportStats& hid = loopStats.hid;
+  logPrintf("[HID] reports=%lu merged=%lu forced=%lu dropped=%lu retried=%lu clamped=%lu keys=%lu key_dropped=%lu key_overflow=%lu\n",
+            static_cast<unsigned long>(hid.sent),
+            static_cast<unsigned long>(hid.merged),
+            static_cast<unsigned long>(hid.forced),
+            static_cast<unsigned long>(hid.dropped),
+            static_cast<unsigned long>(hid.retried),
+            static_cast<unsigned long>(hid.clamped),
+            static_cast<unsigned long>(hid.keySent),
+            static_cast<unsigned long>(hid.keyDropped),
+            static_cast<unsigned long>(hid.keyOverflow));
+  printLatencyLine("all", loopStats.latency);
+  printPowerLine(now, loopStats.link);
+  printProfileLine("loop", ProfileStage::LoopM5Update, ProfileStage::LoopHousekeeping);
+  printProfileLine("motion", ProfileStage::MotionUpdate, ProfileStage::MotionGesture);
+  printProfileLine("ui", ProfileStage::UiBattery, ProfileStage::UiDisplay);
 }
 
 void updateDisplay() {
@@ -748,7 +2736,37 @@ void updateDisplay() {
     return;
   }
   g_lastStatusMs = now;
-  drawStatusScreen();
+  requestStatusFrame();
+}
+
+void uiTask(void* /*arg*/) {
+  for (;;) {
+    {
+      PROFILE_STAGE(ProfileStage::UiBattery);
+      updateBatteryState();
+    }
+    {
+      PROFILE_STAGE(ProfileStage::UiDebug);
+      reportBootBiasCheck();
+      updateDebugOutput();
+    }
+    if (kTelemetryBinary) {
+      PROFILE_STAGE(ProfileStage::UiTelemetry);
+      g_motionTelemetry.drain(Serial);
+      g_hidTelemetry.drain(Serial);
+    }
+    {
+      PROFILE_STAGE(ProfileStage::UiPersistence);
+      updateCalibrationPersistence();
+      updateSettingsPersistence();
+      updateHostPersistence();
+    }
+    {
+      PROFILE_STAGE(ProfileStage::UiDisplay);
+      updateDisplay();
+    }
+    vTaskDelay(pdMS_TO_TICKS(kUiTaskPeriodMs));
+  }
 }
 }  // namespace
 
@@ -760,41 +2778,107 @@ void setup() {
   cfg.output_power = true;
   cfg.fallback_board = m5::board_t::board_M5StickCPlus2;
   M5.begin(cfg);
+  g_buttons.begin();
 
-  Serial.begin(115200);
+  g_imuMutex = xSemaphoreCreateMutex();
+  profileBegin();
+  g_pipeline = MotionPipeline(makePipelineConfig());
+
+  if (kTelemetryBinary) {
+    // Full-rate records need a faster link and a TX buffer that covers one UI-task period.
+    Serial.end();
+    Serial.setTxBufferSize(kTelemetryTxBufferBytes);
+    Serial.begin(kTelemetryBaud);
+  } else {
+    Serial.begin(115200);
+  }
   delay(40);
-  Serial.println("\n[IMUPointer] boot");
-  Serial.printf("[BOOT] board=%d imu=%d\n", static_cast<int>(M5.getBoard()), M5.Imu.isEnabled() ? 1 : 0);
+  logPrintf("\n[IMUPointer] boot\n");
+  logPrintf("[BOOT] board=%d imu=%d\n", static_cast<int>(M5.getBoard()), M5.Imu.isEnabled() ? 1 : 0);
 
   if (!M5.Imu.isEnabled()) {
     M5.In_I2C.begin();
     M5.Imu.begin(&M5.In_I2C, m5::board_t::board_M5StickCPlus2);
-    Serial.printf("[BOOT] forced IMU begin -> %d\n", M5.Imu.isEnabled() ? 1 : 0);
+    logPrintf("[BOOT] forced IMU begin -> %d\n", M5.Imu.isEnabled() ? 1 : 0);
+  }
+
+  if (M5.Imu.isEnabled()) {
+    const bool fifoOk = g_imuFifo.begin();
+    logPrintf("[BOOT] imu fifo %s\n", fifoOk ? "1 kHz burst + 4:1 decimation" : "unavailable, polling registers");
   }
 
   M5.Display.setRotation(kDisplayRotation);
   M5.Display.setTextDatum(top_left);
+  beginDisplayService();
+  markBootPhase(BootPhase::HardwareReady);
+
+  // Advertise first: the host can start connecting while the bias is loaded or measured.
+  bleMouse.setReportMode(kHighResReports ? BleMouseReportMode::HighRes16 : BleMouseReportMode::Legacy8);
+  bleMouse.setReportObserver(onReportSent);
+  loadHostSlots();
+  if (kTelemetryBinary) {
+    telemetryState(g_hidTelemetry, TelemetryEvent::Boot, 0);
+  }
+  bleMouse.begin();
+  markBootPhase(BootPhase::BleAdvertising);
 
-  calibrateGyro(true);
+  loadMenuSettings();
+  if (loadCalibration()) {
+    g_lastCalibrationSaveMs = millis();
+    startBootBiasCheck();
+  } else {
+    logPrintf("[IMU] no stored calibration, running full calibration\n");
+    startCalibration(false);
+  }
+  markBootPhase(BootPhase::CalibrationLoaded);
 
-  bleMouse.begin();
   g_prevConnected = bleMouse.isConnected();
-  g_lastSampleMs = millis();
+  g_lastSampleUs = micros();
   g_lastStatusMs = 0;
   g_lastBatteryMs = 0;
   g_lastDebugMs = 0;
   updateBatteryState();
 
-  drawStatusScreen();
+  requestStatusFrame();
+
+  xTaskCreatePinnedToCore(motionTask, "motion", kMotionTaskStack, nullptr,
+                          kMotionTaskPriority, &g_motionTask, kMotionTaskCore);
+  xTaskCreatePinnedToCore(uiTask, "ui", kUiTaskStack, nullptr,
+                          kUiTaskPriority, &g_uiTask, kUiTaskCore);
+  markBootPhase(BootPhase::MotionStarted);
 }
 
+// Arduino loop task: buttons and the HID path. Sampling, UI and display run in their own tasks.
 void loop() {
-  M5.update();
-  handleUiAndModeButtons();
-  updateClicks();
-  updateMotion();
-  updateBatteryState();
-  updateDebugOutput();
-  updateDisplay();
+  {
+    PROFILE_STAGE(ProfileStage::LoopM5Update);
+    M5.update();
+  }
+  {
+    PROFILE_STAGE(ProfileStage::LoopButtons);
+    handleUiAndModeButtons();
+  }
+  {
+    PROFILE_STAGE(ProfileStage::LoopDrainMotion);
+    drainMotionQueue();
+  }
+  {
+    PROFILE_STAGE(ProfileStage::LoopClicks);
+    updateClicks();
+    drainGestureQueue();
+  }
+  {
+    PROFILE_STAGE(ProfileStage::LoopHidService);
+    bleMouse.service();
+  }
+  {
+    PROFILE_STAGE(ProfileStage::LoopHousekeeping);
+    updateBootTimeline();
+    publishLoopStats();
+    updateCalibration(millis());
+    updateLinkPower();
+    updateTelemetryState();
+    handleSerialCommands();
+  }
   delay(1);
 }